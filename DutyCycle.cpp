@@ -17,9 +17,12 @@
 #include "DutyCycle.hpp"
 #include "MCSOTDMA_Mac.hpp"
 #include <cassert>
+#include <cmath>
 
 using namespace TUHH_INTAIRNET_MCSOTDMA;
 
+constexpr double PPDutyCycleBudget::UNITS_PER_BUDGET;
+
 DutyCycle::DutyCycle(unsigned int period, double max_duty_cycle, unsigned int min_num_supported_pp_links) : period(period), max_duty_cycle(max_duty_cycle), duty_cycle(MovingAverage(period)), min_num_supported_pp_links(min_num_supported_pp_links) {}
 
 DutyCycle::DutyCycle() : DutyCycle(100, 0.1, 4) {}
@@ -40,15 +43,28 @@ void DutyCycle::setMinNumSupportedPPLinks(unsigned int n) {
 	this->min_num_supported_pp_links = std::max(uint(1), n);
 }
 
-std::pair<int, int> DutyCycle::getPeriodicityPP(std::vector<double> used_pp_budgets, std::vector<int> timeouts, double used_sh_budget, int sh_slot_offset) const {
+std::pair<int, int> DutyCycle::getPeriodicityPP(const std::vector<double>& used_pp_budgets, const std::vector<int>& timeouts, double used_sh_budget, int sh_slot_offset) const {
+	return getPeriodicityPP(toAggregate(used_pp_budgets, timeouts), used_sh_budget, sh_slot_offset);
+}
+
+std::pair<int, int> DutyCycle::getPeriodicityPP(const PPDutyCycleBudget& used_pp_budget, double used_sh_budget, int sh_slot_offset) const {
 	switch (this->strategy) {
-		case DutyCycleBudgetStrategy::STATIC: {return this->getPeriodicityPP_STATIC(used_pp_budgets, timeouts, used_sh_budget, sh_slot_offset); break;}
-		case DutyCycleBudgetStrategy::DYNAMIC: {return this->getPeriodicityPP_DYNAMIC(used_pp_budgets, timeouts, used_sh_budget, sh_slot_offset); break;}
+		case DutyCycleBudgetStrategy::STATIC: {return this->getPeriodicityPP_STATIC(); break;}
+		case DutyCycleBudgetStrategy::DYNAMIC: {return this->getPeriodicityPP_DYNAMIC(used_pp_budget, used_sh_budget, sh_slot_offset); break;}
 		default: {throw std::runtime_error("unexpected DutyCycle strategy: " + std::to_string(this->strategy));}
 	}
 }
 
-std::pair<int, int> DutyCycle::getPeriodicityPP_STATIC(std::vector<double> used_pp_budgets, std::vector<int> timeouts, double used_sh_budget, int sh_slot_offset) const {
+PPDutyCycleBudget DutyCycle::toAggregate(const std::vector<double>& used_pp_budgets, const std::vector<int>& timeouts) {
+	if (used_pp_budgets.size() != timeouts.size())
+		throw std::invalid_argument("DutyCycle::toAggregate for " + std::to_string(used_pp_budgets.size()) + " used budgets but " + std::to_string(timeouts.size()) + " timeouts.");
+	PPDutyCycleBudget aggregate;
+	for (size_t i = 0; i < used_pp_budgets.size(); i++)
+		aggregate.set(MacId((int) i), used_pp_budgets.at(i), timeouts.at(i));
+	return aggregate;
+}
+
+std::pair<int, int> DutyCycle::getPeriodicityPP_STATIC() const {
 	// compute statically available budget
 	double avail_budget = this->max_duty_cycle / ((double) this->getMinNumSupportedPPLinks() + 1);  // +1 due to Shared Channel
 	// translate budget to minimum period n, where periodicity is every second burst of 5*2^n => 10*2^n
@@ -57,23 +73,20 @@ std::pair<int, int> DutyCycle::getPeriodicityPP_STATIC(std::vector<double> used_
 	return {min_offset, min_period};
 }
 
-std::pair<int, int> DutyCycle::getPeriodicityPP_DYNAMIC(std::vector<double> used_pp_budgets, std::vector<int> timeouts, double used_sh_budget, int sh_slot_offset) const {	
-	coutd << "computing duty cycle restriction with used_pp_budgets=[";
-	for (auto d : used_pp_budgets)
-		coutd << d << ", ";
-	coutd << "] and used_sh_budget=" << used_sh_budget << " -> max_duty_cycle=" << max_duty_cycle << " and ";
+std::pair<int, int> DutyCycle::getPeriodicityPP_DYNAMIC(const PPDutyCycleBudget& used_pp_budget, double used_sh_budget, int sh_slot_offset) const {	
+	coutd << "computing duty cycle restriction with used_pp_budget=" << used_pp_budget.getTotal() << " over " << used_pp_budget.size() << " links and used_sh_budget=" << used_sh_budget << " -> max_duty_cycle=" << max_duty_cycle << " and ";
 	// check if current budget allows for new PP link
 	double avail_budget = this->max_duty_cycle; 
 	// if the SH uses less than its fair share and this is the last PP link (or later)
-	size_t num_active_links = used_pp_budgets.size();
+	size_t num_active_links = used_pp_budget.size();
 	if (num_active_links >= min_num_supported_pp_links - 1 && used_sh_budget < (this->max_duty_cycle / (min_num_supported_pp_links + 1)))
 		avail_budget -= (this->max_duty_cycle / (min_num_supported_pp_links + 1)); // maximum - fair share for SH
 	else
 		avail_budget -= used_sh_budget; 
 	coutd << avail_budget << " after SH -> ";
 	// reduce by PP budgets
-	for (double d : used_pp_budgets)
-		avail_budget -= d;			
+	int64_t avail_units = PPDutyCycleBudget::toUnits(avail_budget) - used_pp_budget.getTotalUnits();
+	avail_budget = PPDutyCycleBudget::fromUnits(avail_units);
 	coutd << " after " << num_active_links << " PPs -> ";
 	int min_offset;
 	if (avail_budget >= 0.01) {
@@ -82,73 +95,65 @@ std::pair<int, int> DutyCycle::getPeriodicityPP_DYNAMIC(std::vector<double> used
 	// else, check at which time the next link times out, and how much budget is available then
 	} else {
 		coutd << "not sufficient, checking when more budget is available -> ";
-		// add the SH channel access
-		bool sh_timeout_present;	
-		if (sh_slot_offset >= 0)	{		
-			timeouts.push_back(sh_slot_offset);
-			used_pp_budgets.push_back(used_sh_budget);
-			sh_timeout_present = true;
-		} else
-			sh_timeout_present = false;
-		while (avail_budget < 0.01 && !timeouts.empty()) {
-			auto it = std::min_element(std::begin(timeouts), std::end(timeouts));
-			size_t i = std::distance(std::begin(timeouts), it);
-			avail_budget += used_pp_budgets.at(i);
-			min_offset = (*it) + 1;			
-			if (sh_timeout_present) {
-				if (it == timeouts.end() - 1) {
-					sh_timeout_present = false;
-				} else
-					num_active_links--;
-			} else
-				num_active_links--;
-			timeouts.erase(it);
-			used_pp_budgets.erase(used_pp_budgets.begin() + i);
+		// walk through the links in order of their timeouts, and consider the SH channel access as if it timed out at its next slot
+		// on equal timeouts, PP links are considered before the SH
+		bool sh_timeout_present = sh_slot_offset >= 0;
+		auto it = used_pp_budget.getTimeouts().begin();
+		const auto end = used_pp_budget.getTimeouts().end();
+		while (avail_budget < 0.01 && (it != end || sh_timeout_present)) {
+			if (sh_timeout_present && (it == end || sh_slot_offset < it->first)) {
+				avail_units += PPDutyCycleBudget::toUnits(used_sh_budget);
+				min_offset = sh_slot_offset + 1;
+				sh_timeout_present = false;
+			} else {
+				avail_units += PPDutyCycleBudget::toUnits(used_pp_budget.getUsedBudget(it->second));
+				min_offset = it->first + 1;
+				it++;
+			}
+			avail_budget = PPDutyCycleBudget::fromUnits(avail_units);
+		}
+		if (avail_budget < 0.01) {
+			std::stringstream ss;
+			ss << "no duty cycle budget is left (" << std::to_string(avail_budget) << ")" << " for " << used_pp_budget.size() << " PP links with used_pp_budgets=[";
+			for (const auto &pair : used_pp_budget.getTimeouts())
+				ss << used_pp_budget.getUsedBudget(pair.second) << ", ";
+			ss << "] and timeouts=[";
+			for (const auto &pair : used_pp_budget.getTimeouts())
+				ss << pair.first << ", ";
+			ss << "] used_sh_budget=" << used_sh_budget << " sh_slot_offset=" << sh_slot_offset; 
+			throw no_duty_cycle_budget_left_error(ss.str());
 		}
 	}
-	if (avail_budget >= 0.01) {		
-		// translate budget to minimum period n, where periodicity is every second burst of 5*2^n => 10*2^n
-		unsigned int min_period = std::max(0.0, std::ceil(std::log2(1.0/(10.0*avail_budget))));	
-		coutd << "min_offset=" << min_offset << " max_budget=" << avail_budget << " -> min_period=" << min_period << " -> ";
-		return {min_offset, min_period};
-	} else {
-		std::stringstream ss;
-		ss << "no duty cycle budget is left (" << std::to_string(avail_budget) << ")" << " for " << used_pp_budgets.size() << " used_pp_budgets=[";
-		for (auto budget : used_pp_budgets)
-			ss << budget << ", ";
-		ss << "] and " << timeouts.size() << " timeouts=[";
-		for (auto timeout : timeouts)
-			ss << timeout << ", ";
-		ss << "] used_sh_budget=" << used_sh_budget << " sh_slot_offset=" << sh_slot_offset; 
-		throw no_duty_cycle_budget_left_error(ss.str());
-	}
+	// translate budget to minimum period n, where periodicity is every second burst of 5*2^n => 10*2^n
+	unsigned int min_period = std::max(0.0, std::ceil(std::log2(1.0/(10.0*avail_budget))));	
+	coutd << "min_offset=" << min_offset << " max_budget=" << avail_budget << " -> min_period=" << min_period << " -> ";
+	return {min_offset, min_period};
 }
 
 double DutyCycle::getSHBudget(const std::vector<double>& used_budget) const {
+	return getSHBudget(toAggregate(used_budget, std::vector<int>(used_budget.size(), 0)));
+}
+
+double DutyCycle::getSHBudget(const PPDutyCycleBudget& used_pp_budget) const {
 	switch (this->strategy) {
-		case DutyCycleBudgetStrategy::STATIC: {return this->getSHBudget_STATIC(used_budget); break;}
-		case DutyCycleBudgetStrategy::DYNAMIC: {return this->getSHBudget_DYNAMIC(used_budget); break;}
+		case DutyCycleBudgetStrategy::STATIC: {return this->getSHBudget_STATIC(); break;}
+		case DutyCycleBudgetStrategy::DYNAMIC: {return this->getSHBudget_DYNAMIC(used_pp_budget); break;}
 		default: {throw std::runtime_error("unexpected DutyCycle strategy: " + std::to_string(this->strategy)); break;}
 	}
 }
 
-double DutyCycle::getSHBudget_STATIC(const std::vector<double>& used_budget) const {	
+double DutyCycle::getSHBudget_STATIC() const {	
 	// compute statically available budget
 	double avail_budget = this->max_duty_cycle / ((double) this->getMinNumSupportedPPLinks() + 1);
 	return avail_budget;
 }
 
-double DutyCycle::getSHBudget_DYNAMIC(const std::vector<double>& used_budget) const {	
-	double avail_budget = this->max_duty_cycle;		
-	size_t num_active_pp_links = used_budget.size();	
-	for (double d : used_budget) 
-		avail_budget -= d;
+double DutyCycle::getSHBudget_DYNAMIC(const PPDutyCycleBudget& used_pp_budget) const {	
+	double avail_budget = PPDutyCycleBudget::fromUnits(PPDutyCycleBudget::toUnits(this->max_duty_cycle) - used_pp_budget.getTotalUnits());
+	size_t num_active_pp_links = used_pp_budget.size();	
 	if (avail_budget <= 0.01) {
 		std::stringstream ss;
-		ss << "avail_budget=" << avail_budget << " when computing SH budget after used_budget=[";
-		for (auto d : used_budget)
-			ss << d << ", ";
-		ss << "] and " << num_active_pp_links << " active PP links";
+		ss << "avail_budget=" << avail_budget << " when computing SH budget after used_budget=" << used_pp_budget.getTotal() << " and " << num_active_pp_links << " active PP links";
 		throw std::runtime_error(ss.str());
 	}	
 	// if not all PP links have been established yet	
@@ -156,10 +161,7 @@ double DutyCycle::getSHBudget_DYNAMIC(const std::vector<double>& used_budget) co
 		avail_budget -= this->max_duty_cycle / ((double) min_num_supported_pp_links + 1); // leave budget to establish next PP link immediately
 	if (avail_budget == std::numeric_limits<double>::infinity() || avail_budget == -std::numeric_limits<double>::infinity()) {
 		std::stringstream ss;
-		ss << "sh_budget=inf for " << used_budget.size() << " used_budget=[";
-		for (auto d : used_budget)
-			ss << d << ", ";
-		ss << "] and " << num_active_pp_links << " active PP links";
+		ss << "sh_budget=inf for used_budget=" << used_pp_budget.getTotal() << " and " << num_active_pp_links << " active PP links";
 		throw std::runtime_error(ss.str());
 	}
 		
@@ -168,8 +170,12 @@ double DutyCycle::getSHBudget_DYNAMIC(const std::vector<double>& used_budget) co
 }
 
 int DutyCycle::getOffsetSH(const std::vector<double>& used_budget) const {
+	return getOffsetSH(toAggregate(used_budget, std::vector<int>(used_budget.size(), 0)));
+}
+
+int DutyCycle::getOffsetSH(const PPDutyCycleBudget& used_pp_budget) const {
 	// compute available budget	
-	double avail_budget = getSHBudget(used_budget);
+	double avail_budget = getSHBudget(used_pp_budget);
 	int slot_offset = std::max(1.0, 1.0 / avail_budget);	
 	return slot_offset;
 }
@@ -178,6 +184,85 @@ double DutyCycle::getTotalBudget() const {
 	return max_duty_cycle;
 }
 
+unsigned int DutyCycle::getMaxNumTransmissionsPerPeriod() const {
+	// small epsilon s.t. e.g. 0.1*100 isn't rounded down to 9
+	return (unsigned int) std::floor(max_duty_cycle * period + 1e-9);
+}
+
+unsigned int DutyCycle::getMaxScheduledTransmissions(const ReservationTable *tx_table, int start_offset, unsigned int num_windows) const {
+	const int planning_horizon = (int) tx_table->getPlanningHorizon();
+	const int window = std::min((int) period, 2*planning_horizon + 1);
+	int first_start = std::max(start_offset, -planning_horizon);
+	int last_start = std::min(start_offset + (int) num_windows - 1, planning_horizon - window + 1);
+	if (num_windows == 0 || first_start > last_start)
+		return 0;
+	// count the first window through popcounts, then slide it one slot at a time
+	unsigned int num_txs = tx_table->countTxReservations(first_start, window);
+	unsigned int max_num_txs = num_txs;
+	for (int t = first_start + 1; t <= last_start; t++) {
+		num_txs -= tx_table->countTxReservations(t - 1, 1);
+		num_txs += tx_table->countTxReservations(t + window - 1, 1);
+		max_num_txs = std::max(max_num_txs, num_txs);
+	}
+	return max_num_txs;
+}
+
+bool DutyCycle::isForecastConformant(const ReservationTable *tx_table, const std::vector<int>& tx_slot_offsets) const {
+	if (tx_slot_offsets.empty())
+		return true;
+	const int planning_horizon = (int) tx_table->getPlanningHorizon();
+	const int window = std::min((int) period, 2*planning_horizon + 1);
+	const unsigned int max_num_txs = getMaxNumTransmissionsPerPeriod();
+	// all windows that contain any of the additional transmissions
+	int first_start = std::max(tx_slot_offsets.front() - window + 1, -planning_horizon);
+	int last_start = std::min(tx_slot_offsets.back(), planning_horizon - window + 1);
+	if (first_start > last_start)
+		return tx_slot_offsets.size() <= max_num_txs;
+	unsigned int num_txs = tx_table->countTxReservations(first_start, window);
+	// [lo, hi) are the additional transmissions within the current window
+	size_t lo = 0, hi = 0;
+	for (int t = first_start; t <= last_start; t++) {
+		if (t > first_start) {
+			num_txs -= tx_table->countTxReservations(t - 1, 1);
+			num_txs += tx_table->countTxReservations(t + window - 1, 1);
+		}
+		while (lo < tx_slot_offsets.size() && tx_slot_offsets.at(lo) < t)
+			lo++;
+		while (hi < tx_slot_offsets.size() && tx_slot_offsets.at(hi) < t + window)
+			hi++;
+		if (hi > lo && num_txs + (hi - lo) > max_num_txs)
+			return false;
+	}
+	return true;
+}
+
+int DutyCycle::getEarliestConformantOffset(const ReservationTable *tx_table, int min_offset) const {
+	const int planning_horizon = (int) tx_table->getPlanningHorizon();
+	const int window = std::min((int) period, 2*planning_horizon + 1);
+	const unsigned int max_num_txs = getMaxNumTransmissionsPerPeriod();
+	int first_start = std::max(min_offset - window + 1, -planning_horizon);
+	int last_start = planning_horizon - window + 1;
+	if (max_num_txs == 0 || min_offset > planning_horizon || first_start > last_start)
+		return -1;
+	// a transmission at t fits if no window that contains it is already full, 
+	// so remember the start of the latest full window while sliding
+	int latest_full_window_start = std::numeric_limits<int>::min();
+	unsigned int num_txs = tx_table->countTxReservations(first_start, window);
+	for (int t = first_start; t <= planning_horizon; t++) {
+		if (t <= last_start) {
+			if (t > first_start) {
+				num_txs -= tx_table->countTxReservations(t - 1, 1);
+				num_txs += tx_table->countTxReservations(t + window - 1, 1);
+			}
+			if (num_txs >= max_num_txs)
+				latest_full_window_start = t;
+		}
+		if (t >= min_offset && latest_full_window_start < t - window + 1 && tx_table->countTxReservations(t, 1) == 0)
+			return t;
+	}
+	return -1;
+}
+
 unsigned int DutyCycle::getMinNumSupportedPPLinks() const {
 	return this->min_num_supported_pp_links;
 }
@@ -188,4 +273,71 @@ void DutyCycle::setStrategy(const DutyCycleBudgetStrategy& strategy) {
 
 DutyCycleBudgetStrategy DutyCycle::getStrategy() const {
 	return this->strategy;
-}
\ No newline at end of file
+}
+void PPDutyCycleBudget::set(const MacId& id, double used_budget, int timeout) {
+	auto it = links.find(id);
+	if (it == links.end())
+		links.emplace(id, std::pair<double, int>(used_budget, timeout));
+	else {
+		total_units -= toUnits(it->second.first);
+		timeouts.erase({it->second.second, id});
+		it->second = {used_budget, timeout};
+	}
+	total_units += toUnits(used_budget);
+	timeouts.insert({timeout, id});
+}
+
+void PPDutyCycleBudget::remove(const MacId& id) {
+	auto it = links.find(id);
+	if (it == links.end())
+		return;
+	total_units -= toUnits(it->second.first);
+	timeouts.erase({it->second.second, id});
+	links.erase(it);
+}
+
+bool PPDutyCycleBudget::contains(const MacId& id) const {
+	return links.find(id) != links.end();
+}
+
+size_t PPDutyCycleBudget::size() const {
+	return links.size();
+}
+
+double PPDutyCycleBudget::getTotal() const {
+	return fromUnits(total_units);
+}
+
+int64_t PPDutyCycleBudget::getTotalUnits() const {
+	return total_units;
+}
+
+int64_t PPDutyCycleBudget::toUnits(double budget) {
+	return std::llround(budget * UNITS_PER_BUDGET);
+}
+
+double PPDutyCycleBudget::fromUnits(int64_t units) {
+	return ((double) units) / UNITS_PER_BUDGET;
+}
+
+double PPDutyCycleBudget::getUsedBudget(const MacId& id) const {
+	auto it = links.find(id);
+	if (it == links.end())
+		throw std::invalid_argument("PPDutyCycleBudget::getUsedBudget for unknown link ID " + std::to_string(id.getId()));
+	return it->second.first;
+}
+
+const std::set<std::pair<int, MacId>>& PPDutyCycleBudget::getTimeouts() const {
+	return timeouts;
+}
+
+std::pair<std::vector<double>, std::vector<int>> PPDutyCycleBudget::toVectors() const {
+	std::pair<std::vector<double>, std::vector<int>> vectors;
+	vectors.first.reserve(links.size());
+	vectors.second.reserve(links.size());
+	for (const auto &pair : links) {
+		vectors.first.push_back(pair.second.first);
+		vectors.second.push_back(pair.second.second);
+	}
+	return vectors;
+}
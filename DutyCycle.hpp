@@ -19,17 +19,66 @@
 
 #include "DutyCycleBudgetStrategy.hpp"
 #include "MovingAverage.hpp"
+#include <MacId.hpp>
 #include <string>
 #include <stdexcept>
+#include <vector>
+#include <map>
+#include <set>
 
 namespace TUHH_INTAIRNET_MCSOTDMA {		
 
+	class ReservationTable;
+
 	class no_duty_cycle_budget_left_error : public std::runtime_error {
 	public:
 		explicit no_duty_cycle_budget_left_error(const std::string& arg) : std::runtime_error(arg) {}
 	};
 
 
+	/**
+	 * Running aggregate of the duty cycle budget used by active PP links.
+	 * Link managers report changes as they happen, s.t. the total is always at hand and timeouts are kept in ascending order.
+	 * Budgets are summed in fixed-point units, s.t. the total does not depend on the order in which links come and go.
+	 */
+	class PPDutyCycleBudget {
+
+		friend class SystemTests;
+
+		public:
+			/**
+			 * Adds a link or updates its contribution.
+			 * @param id Link ID.
+			 * @param used_budget Number of transmissions per time slot.
+			 * @param timeout Remaining timeout.
+			 */
+			void set(const MacId& id, double used_budget, int timeout);
+			/** Removes a link if present. */
+			void remove(const MacId& id);
+			bool contains(const MacId& id) const;
+			/** @return Number of links. */
+			size_t size() const;
+			/** @return Sum of the links' used budgets. */
+			double getTotal() const;
+			double getUsedBudget(const MacId& id) const;
+			/** @return <timeout, link ID> pairs in ascending order. */
+			const std::set<std::pair<int, MacId>>& getTimeouts() const;
+			/** @return <used budget per link, timeout per link>, ordered by link ID. */
+			std::pair<std::vector<double>, std::vector<int>> toVectors() const;
+
+			static int64_t toUnits(double budget);
+			static double fromUnits(int64_t units);
+			int64_t getTotalUnits() const;
+
+		protected:
+			/** Budget resolution. */
+			static constexpr double UNITS_PER_BUDGET = 1e12;
+			/** Link ID -> <used budget, timeout>. */
+			std::map<MacId, std::pair<double, int>> links;
+			std::set<std::pair<int, MacId>> timeouts;
+			int64_t total_units = 0;
+	};
+
 	/**	 
 	 * Budget calculations with regard to the duty cycle.
 	 */
@@ -81,16 +130,47 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			 * @param sh_slot_offset offset until next SH channel access
 			 * @return <Minimum slot offset, Minimum number of time slots in-between two transmission bursts so that the duty cycle budget is maintained>
 			 */
-			std::pair<int, int> getPeriodicityPP(std::vector<double> used_pp_budgets, std::vector<int> timeouts, double used_sh_budget, int sh_slot_offset) const;						
+			std::pair<int, int> getPeriodicityPP(const std::vector<double>& used_pp_budgets, const std::vector<int>& timeouts, double used_sh_budget, int sh_slot_offset) const;
+			/** Same as above, but works on the running aggregate without copying. */
+			std::pair<int, int> getPeriodicityPP(const PPDutyCycleBudget& used_pp_budget, double used_sh_budget, int sh_slot_offset) const;
 			double getSHBudget(const std::vector<double>& used_budget) const;			
+			double getSHBudget(const PPDutyCycleBudget& used_pp_budget) const;
 			int getOffsetSH(const std::vector<double>& used_budget) const;			
+			int getOffsetSH(const PPDutyCycleBudget& used_pp_budget) const;
 			double getTotalBudget() const;						
 
+			/**
+			 * @return Maximum number of transmissions within any window of 'period' time slots.
+			 */
+			unsigned int getMaxNumTransmissionsPerPeriod() const;
+			/**
+			 * Forecast of the duty cycle from what has already been scheduled.
+			 * @param tx_table Transmitter reservation table, which holds all scheduled transmissions.
+			 * @param start_offset Start of the first window.
+			 * @param num_windows Number of consecutive windows to consider; windows that exceed the planning horizon are skipped.
+			 * @return The largest number of transmissions scheduled in any window of 'period' time slots that starts within [start_offset, start_offset + num_windows).
+			 */
+			unsigned int getMaxScheduledTransmissions(const ReservationTable *tx_table, int start_offset, unsigned int num_windows) const;
+			/**
+			 * @param tx_table Transmitter reservation table, which holds all scheduled transmissions.
+			 * @param tx_slot_offsets Additional transmissions in ascending order.
+			 * @return Whether every window of 'period' time slots that contains any of the additional transmissions stays within the maximum duty cycle.
+			 */
+			bool isForecastConformant(const ReservationTable *tx_table, const std::vector<int>& tx_slot_offsets) const;
+			/**
+			 * @param tx_table Transmitter reservation table, which holds all scheduled transmissions.
+			 * @param min_offset
+			 * @return The earliest slot offset >= min_offset at which one more transmission stays within the maximum duty cycle, or -1 if there is none within the planning horizon.
+			 */
+			int getEarliestConformantOffset(const ReservationTable *tx_table, int min_offset) const;
+
 		protected:
-			std::pair<int, int> getPeriodicityPP_STATIC(std::vector<double> used_pp_budgets, std::vector<int> timeouts, double used_sh_budget, int sh_slot_offset) const;
-			std::pair<int, int> getPeriodicityPP_DYNAMIC(std::vector<double> used_pp_budgets, std::vector<int> timeouts, double used_sh_budget, int sh_slot_offset) const;
-			double getSHBudget_STATIC(const std::vector<double>& used_budget) const;
-			double getSHBudget_DYNAMIC(const std::vector<double>& used_budget) const;			
+			/** @return An aggregate holding the given links under consecutive IDs, s.t. ties between timeouts are broken by vector index. */
+			static PPDutyCycleBudget toAggregate(const std::vector<double>& used_pp_budgets, const std::vector<int>& timeouts);
+			std::pair<int, int> getPeriodicityPP_STATIC() const;
+			std::pair<int, int> getPeriodicityPP_DYNAMIC(const PPDutyCycleBudget& used_pp_budget, double used_sh_budget, int sh_slot_offset) const;
+			double getSHBudget_STATIC() const;
+			double getSHBudget_DYNAMIC(const PPDutyCycleBudget& used_pp_budget) const;			
 
 		protected:
 			/** Number of time slots to consider when computing the duty cycle. */
@@ -0,0 +1,129 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include "LatencyHistogram.hpp"
+
+using namespace TUHH_INTAIRNET_MCSOTDMA;
+
+const unsigned int LatencyHistogram::SUB_BUCKET_BITS;
+const uint64_t LatencyHistogram::NUM_SUB_BUCKETS;
+const unsigned int LatencyHistogram::MAX_VALUE_BITS;
+const size_t LatencyHistogram::NUM_BUCKETS;
+
+LatencyHistogram::LatencyHistogram() {
+	reset();
+}
+
+size_t LatencyHistogram::getBucketIndex(uint64_t value) {
+	if (value < NUM_SUB_BUCKETS)
+		return (size_t) value;
+	// position of the most significant bit
+	unsigned int msb = 0;
+	for (uint64_t v = value; v > 1; v >>= 1)
+		msb++;
+	// each power of two above the exact range is split into NUM_SUB_BUCKETS/2 linear buckets
+	unsigned int group = msb - SUB_BUCKET_BITS + 1;
+	uint64_t sub_bucket = value >> group;
+	return (size_t) (NUM_SUB_BUCKETS + (group - 1) * (NUM_SUB_BUCKETS / 2) + (sub_bucket - NUM_SUB_BUCKETS / 2));
+}
+
+uint64_t LatencyHistogram::getBucketLowerBound(size_t index) {
+	if (index < NUM_SUB_BUCKETS)
+		return index;
+	unsigned int group = (unsigned int) ((index - NUM_SUB_BUCKETS) / (NUM_SUB_BUCKETS / 2)) + 1;
+	uint64_t sub_bucket = (index - NUM_SUB_BUCKETS) % (NUM_SUB_BUCKETS / 2) + NUM_SUB_BUCKETS / 2;
+	return sub_bucket << group;
+}
+
+uint64_t LatencyHistogram::getBucketUpperBound(size_t index) {
+	if (index < NUM_SUB_BUCKETS)
+		return index;
+	unsigned int group = (unsigned int) ((index - NUM_SUB_BUCKETS) / (NUM_SUB_BUCKETS / 2)) + 1;
+	return getBucketLowerBound(index) + (uint64_t(1) << group) - 1;
+}
+
+void LatencyHistogram::record(double value) {
+	const uint64_t max_recordable = (uint64_t(1) << MAX_VALUE_BITS) - 1;
+	uint64_t v;
+	if (!(value > 0.0))
+		v = 0;
+	else if (value >= (double) max_recordable)
+		v = max_recordable;
+	else
+		v = (uint64_t) std::llround(value);
+	buckets[getBucketIndex(v)]++;
+	num_samples++;
+	sum += (double) v;
+	min_value = std::min(min_value, v);
+	max_value = std::max(max_value, v);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+	for (size_t i = 0; i < NUM_BUCKETS; i++)
+		buckets[i] += other.buckets[i];
+	num_samples += other.num_samples;
+	sum += other.sum;
+	min_value = std::min(min_value, other.min_value);
+	max_value = std::max(max_value, other.max_value);
+}
+
+void LatencyHistogram::reset() {
+	buckets.fill(0);
+	num_samples = 0;
+	sum = 0.0;
+	min_value = std::numeric_limits<uint64_t>::max();
+	max_value = 0;
+}
+
+double LatencyHistogram::getQuantile(double quantile) const {
+	if (quantile < 0.0 || quantile > 1.0)
+		throw std::invalid_argument("LatencyHistogram::getQuantile for quantile outside [0, 1]: " + std::to_string(quantile));
+	if (num_samples == 0)
+		return 0.0;
+	// the rank of the sample that is sought, starting at 1
+	uint64_t rank = std::max(uint64_t(1), (uint64_t) std::ceil(quantile * (double) num_samples));
+	uint64_t num_seen = 0;
+	for (size_t i = 0; i < NUM_BUCKETS; i++) {
+		num_seen += buckets[i];
+		if (num_seen >= rank) {
+			// report the bucket's midpoint, but never more than was actually observed
+			uint64_t lower = std::max(getBucketLowerBound(i), min_value), upper = std::min(getBucketUpperBound(i), max_value);
+			return (double) (lower + (upper - lower) / 2);
+		}
+	}
+	return (double) max_value;
+}
+
+uint64_t LatencyHistogram::getNumSamples() const {
+	return num_samples;
+}
+
+double LatencyHistogram::getMean() const {
+	return num_samples == 0 ? 0.0 : sum / (double) num_samples;
+}
+
+uint64_t LatencyHistogram::getMin() const {
+	return num_samples == 0 ? 0 : min_value;
+}
+
+uint64_t LatencyHistogram::getMax() const {
+	return max_value;
+}
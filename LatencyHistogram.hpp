@@ -0,0 +1,80 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef TUHH_INTAIRNET_MC_SOTDMA_LATENCYHISTOGRAM_HPP
+#define TUHH_INTAIRNET_MC_SOTDMA_LATENCYHISTOGRAM_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+
+	/**
+	 * Constant-memory histogram with log-linear buckets: values below 2^SUB_BUCKET_BITS are counted exactly,
+	 * larger ones in NUM_SUB_BUCKETS/2 linear buckets per power of two, which bounds the relative error to 2^-(SUB_BUCKET_BITS-1).
+	 * Values are non-negative integers, such as time slots, and clamped to [0, 2^MAX_VALUE_BITS - 1].
+	 */
+	class LatencyHistogram {
+
+		friend class LatencyHistogramTests;
+
+	public:
+		static const unsigned int SUB_BUCKET_BITS = 4;
+		static const uint64_t NUM_SUB_BUCKETS = uint64_t(1) << SUB_BUCKET_BITS;
+		static const unsigned int MAX_VALUE_BITS = 32;
+		static const size_t NUM_BUCKETS = NUM_SUB_BUCKETS + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * (NUM_SUB_BUCKETS / 2);
+
+		LatencyHistogram();
+
+		/**
+		 * @param value Rounded to the nearest integer.
+		 */
+		void record(double value);
+
+		/** Adds all samples of 'other' to this histogram, e.g. to aggregate over several users. */
+		void merge(const LatencyHistogram &other);
+
+		void reset();
+
+		/**
+		 * @param quantile In [0, 1], e.g. 0.99 for the 99th percentile.
+		 * @return Representative value of the bucket that holds the quantile, or 0 if nothing was recorded.
+		 * @throws std::invalid_argument if quantile is outside [0, 1].
+		 */
+		double getQuantile(double quantile) const;
+
+		uint64_t getNumSamples() const;
+		double getMean() const;
+		uint64_t getMin() const;
+		uint64_t getMax() const;
+
+	protected:
+		static size_t getBucketIndex(uint64_t value);
+		/** @return Smallest value that falls into this bucket. */
+		static uint64_t getBucketLowerBound(size_t index);
+		/** @return Largest value that falls into this bucket. */
+		static uint64_t getBucketUpperBound(size_t index);
+
+		std::array<uint64_t, NUM_BUCKETS> buckets;
+		uint64_t num_samples = 0;
+		double sum = 0.0;
+		uint64_t min_value, max_value = 0;
+	};
+}
+
+#endif //TUHH_INTAIRNET_MC_SOTDMA_LATENCYHISTOGRAM_HPP
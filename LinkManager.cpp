@@ -140,6 +140,23 @@ void LinkManager::onSlotEnd() {
 	}
 }
 
+void LinkManager::updateOutgoingTrafficEstimate() {
+	outgoing_traffic_estimate.put(num_outgoing_bits_this_slot);
+	num_outgoing_bits_this_slot = 0;
+}
+
+void LinkManager::reportOutgoingBits(unsigned long num_bits) {
+	num_outgoing_bits_this_slot += num_bits;
+}
+
+double LinkManager::getOutgoingTrafficEstimate() const {
+	return outgoing_traffic_estimate.get();
+}
+
+double LinkManager::getOutgoingBacklogEstimate() const {
+	return outgoing_traffic_estimate.get() + num_outgoing_bits_this_slot;
+}
+
 void LinkManager::onReceptionReservation() {	
 	expected_reception_this_slot = true;
 }
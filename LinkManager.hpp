@@ -25,6 +25,7 @@
 #include "FrequencyChannel.hpp"
 #include "ReservationTable.hpp"
 #include "ReservationManager.hpp"
+#include "MovingAverage.hpp"
 
 namespace TUHH_INTAIRNET_MCSOTDMA {
 
@@ -55,7 +56,8 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		};
 
 		LinkManager(const MacId& link_id, ReservationManager *reservation_manager, MCSOTDMA_Mac *mac) : link_id(link_id), reservation_manager(reservation_manager), mac(mac),
-		                                                                                                link_status((link_id == SYMBOLIC_LINK_ID_BROADCAST || link_id == SYMBOLIC_LINK_ID_BEACON) ? Status::link_established : Status::link_not_established) /* broadcast links are always established */ {
+		                                                                                                link_status((link_id == SYMBOLIC_LINK_ID_BROADCAST || link_id == SYMBOLIC_LINK_ID_BEACON) ? Status::link_established : Status::link_not_established) /* broadcast links are always established */,
+		                                                                                                outgoing_traffic_estimate(100) {
 		                                                                                                }
 
 	    virtual ~LinkManager() = default;
@@ -83,6 +85,27 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 */
 		virtual void notifyOutgoing(unsigned long num_bits) = 0;
 
+		/**
+		 * Accounts for outgoing data in the traffic estimate, independent of when notifyOutgoing() is called.
+		 * @param num_bits
+		 */
+		void reportOutgoingBits(unsigned long num_bits);
+
+		/**
+		 * @return Average number of bits per time slot that upper layers have notified this link of.
+		 */
+		double getOutgoingTrafficEstimate() const;
+
+		/**
+		 * @return Bits reported during the current slot on top of the usual traffic per slot.
+		 */
+		double getOutgoingBacklogEstimate() const;
+
+		/**
+		 * Concludes the current slot's traffic estimate. Unlike onSlotEnd(), which subclasses may call more than once, the MAC calls this exactly once per slot.
+		 */
+		void updateOutgoingTrafficEstimate();
+
 		/**
 		 * Called on slot start.
 		 * @param num_slots Number of slots that have passed.
@@ -140,6 +163,10 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		bool reported_missing_packet_to_arq = false;
 		/** Flag to indicate whether a missing packet should be reported to ARQ. Defaults to true. */
 		bool should_report_missing_packets_to_arq = true;
+		/** Number of outgoing bits per time slot, see updateOutgoingTrafficEstimate(). */
+		MovingAverage outgoing_traffic_estimate;
+		/** Outgoing bits reported during the current slot. */
+		unsigned long num_outgoing_bits_this_slot = 0;
 	};
 
 	inline std::ostream& operator<<(std::ostream& stream, const LinkManager& lm) {
@@ -14,37 +14,71 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include "LinkProposalFinder.hpp"
 
 std::vector<LinkProposal> LinkProposalFinder::findLinkProposals(size_t num_proposals, int min_time_slot_offset, int num_forward_bursts, int num_reverse_bursts, int period, int timeout, bool should_learn_dme_activity, const ReservationManager *reservation_manager, MCSOTDMA_Mac *mac) {
-	std::vector<LinkProposal> proposals;	
-	// get reservation tables sorted by their numbers of idle slots
+	// the earliest slot of each of the first num_proposals channels that have one
+	return findRankedLinkProposals(num_proposals, 1, min_time_slot_offset, num_forward_bursts, num_reverse_bursts, period, period, timeout, reservation_manager, mac);
+}
+
+std::vector<LinkProposal> LinkProposalFinder::findRankedLinkProposals(size_t num_proposals, size_t num_candidates_per_channel, int min_time_slot_offset, int num_forward_bursts, int num_reverse_bursts, int min_period, int max_period, int timeout, const ReservationManager *reservation_manager, MCSOTDMA_Mac *mac) {
+	PROFILE_PHASE(mac != nullptr ? &mac->getSlotProfiler() : nullptr, SlotProfiler::link_proposal_finder_find_link_proposals);
+	// get reservation tables sorted by their numbers of idle slots, except for blacklisted channels
+	std::vector<const ReservationTable*> tables;
 	auto tables_queue = reservation_manager->getSortedP2PReservationTables();
-	// until we've considered a sufficient number of channels or have run out of channels
-	size_t num_channels_considered = 0;
-	while (num_channels_considered < num_proposals && !tables_queue.empty()) {
-		// get the next reservation table
-		auto *table = tables_queue.top();
+	while (!tables_queue.empty()) {
+		if (!tables_queue.top()->getLinkedChannel()->isBlocked())
+			tables.push_back(tables_queue.top());
 		tables_queue.pop();
-		// make sure the channel's not blacklisted
-		if (table->getLinkedChannel()->isBlocked())
-			continue;
-		// find time slots to propose
-		auto candidate_slots = table->findPPCandidates(1, min_time_slot_offset, num_forward_bursts, num_reverse_bursts, period, timeout);
-		coutd << "found " << candidate_slots.size() << " slots on " << *table->getLinkedChannel() << ": ";
-		for (int32_t slot : candidate_slots)
-			coutd << "t=" << slot << " ";
-		coutd << " -> ";
-		if (!candidate_slots.empty()) {
-			// save it
-			LinkProposal proposal;
-			proposal.center_frequency = table->getLinkedChannel()->getCenterFrequency();
-			proposal.period = period;		
-			proposal.slot_offset = (int) candidate_slots.at(0);
-			proposals.push_back(proposal);		
-			// increment number of channels that have been considered
-			num_channels_considered++;
+	}
+	// finds a channel's candidates, sorted by start slot and then period
+	auto find_candidates = [&](const ReservationTable *table) {
+		const auto candidate_slots = table->findPPCandidates(num_candidates_per_channel, min_time_slot_offset, num_forward_bursts, num_reverse_bursts, min_period, max_period, timeout);
+		std::vector<LinkProposal> candidates;
+		for (size_t i = 0; i < candidate_slots.size(); i++) {
+			for (unsigned int slot : candidate_slots.at(i)) {
+				LinkProposal proposal;
+				proposal.center_frequency = table->getLinkedChannel()->getCenterFrequency();
+				proposal.period = min_period + (int) i;
+				proposal.slot_offset = (int) slot;
+				candidates.push_back(proposal);
+			}
+		}
+		std::stable_sort(candidates.begin(), candidates.end(), [](const LinkProposal &a, const LinkProposal &b) {return a.slot_offset < b.slot_offset || (a.slot_offset == b.slot_offset && a.period < b.period);});
+		return candidates;
+	};
+	// the candidates of the first num_proposals channels that have any, as all remaining channels would only rank behind them
+	std::vector<std::vector<LinkProposal>> channel_candidates;
+	WorkerPool *worker_pool = mac != nullptr ? mac->getLinkProposalWorkerPool() : nullptr;
+	size_t num_searches = tables.size() * (size_t) std::max(0, max_period - min_period + 1);
+	if (worker_pool != nullptr && num_searches >= mac->getMinNumParallelLinkProposalSearches()) {
+		// search all channels concurrently, and then pick them in the same order as below
+		std::vector<std::vector<LinkProposal>> all_channel_candidates(tables.size());
+		worker_pool->run(tables.size(), [&](size_t i) {all_channel_candidates.at(i) = find_candidates(tables.at(i));});
+		for (size_t i = 0; i < tables.size() && channel_candidates.size() < num_proposals; i++)
+			if (!all_channel_candidates.at(i).empty())
+				channel_candidates.push_back(std::move(all_channel_candidates.at(i)));
+	} else {
+		for (size_t i = 0; i < tables.size() && channel_candidates.size() < num_proposals; i++) {
+			auto candidates = find_candidates(tables.at(i));
+			if (!candidates.empty())
+				channel_candidates.push_back(std::move(candidates));
+		}
+	}
+	coutd << "found candidates on " << channel_candidates.size() << " channels -> ";
+	// rank the best candidates of all channels first, then the second-best, etc.
+	std::vector<LinkProposal> proposals;
+	for (size_t rank = 0; proposals.size() < num_proposals; rank++) {
+		bool found_any = false;
+		for (size_t channel = 0; channel < channel_candidates.size() && proposals.size() < num_proposals; channel++) {
+			if (rank < channel_candidates.at(channel).size()) {
+				proposals.push_back(channel_candidates.at(channel).at(rank));
+				found_any = true;
+			}
 		}
-	}	
+		if (!found_any)
+			break;
+	}
 	return proposals;
 }
\ No newline at end of file
@@ -25,6 +25,26 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 	class LinkProposalFinder {
 	public:
 		static std::vector<LinkProposal> findLinkProposals(size_t num_proposals, int min_time_slot_offset, int num_forward_bursts, int num_reverse_bursts, int period, int timeout, bool should_learn_dme_activity, const ReservationManager *reservation_manager, MCSOTDMA_Mac *mac);
+
+		/**
+		 * Finds several candidates per channel and period in one pass over each reservation table, and ranks them.
+		 * The best candidate of each channel comes first, with channels in the order of findLinkProposals(), followed by the second-best of each channel, and so on.
+		 * Within a channel, earlier start slots and then shorter periods are better.
+		 * With one candidate per channel and min_period=max_period, this yields the same proposals as findLinkProposals().
+		 * If the MAC has enabled parallel searches and enough channels and periods are to be searched, then channels are searched concurrently, with the same results.
+		 * @param num_proposals Maximum number of proposals.
+		 * @param num_candidates_per_channel Maximum number of proposals per channel and period.
+		 * @param min_time_slot_offset 
+		 * @param num_forward_bursts 
+		 * @param num_reverse_bursts 
+		 * @param min_period Shortest permissible period.
+		 * @param max_period Longest permissible period.
+		 * @param timeout 
+		 * @param reservation_manager 
+		 * @param mac 
+		 * @return Ranked link proposals.
+		 */
+		static std::vector<LinkProposal> findRankedLinkProposals(size_t num_proposals, size_t num_candidates_per_channel, int min_time_slot_offset, int num_forward_bursts, int num_reverse_bursts, int min_period, int max_period, int timeout, const ReservationManager *reservation_manager, MCSOTDMA_Mac *mac);
 	};
 }
 
@@ -21,27 +21,68 @@
 #include "SHLinkManager.hpp"
 #include <IPhy.hpp>
 #include <cassert>
+#include <algorithm>
 
 using namespace TUHH_INTAIRNET_MCSOTDMA;
 
-MCSOTDMA_Mac::MCSOTDMA_Mac(const MacId& id, uint32_t planning_horizon) : IMac(id), reservation_manager(new ReservationManager(planning_horizon)), neighbor_observer(50000), duty_cycle(DutyCycle(default_duty_cycle_period, default_max_duty_cycle, default_min_num_supported_pp_links)) {
+MCSOTDMA_Mac::MCSOTDMA_Mac(const MacId& id, uint32_t planning_horizon) : IMac(id), reservation_manager(new ReservationManager(planning_horizon)), third_party_link_idle_timeout(planning_horizon), neighbor_observer(50000), duty_cycle(DutyCycle(default_duty_cycle_period, default_max_duty_cycle, default_min_num_supported_pp_links)) {
 	stat_broadcast_mac_delay.dontEmitBeforeFirstReport();	
 	stat_broadcast_candidate_slots.dontEmitBeforeFirstReport();
 	stat_broadcast_selected_candidate_slots.dontEmitBeforeFirstReport();
 	stat_pp_link_establishment_time.dontEmitBeforeFirstReport();		
+	for (auto* stat : statistics)
+		statistic_registry.add(stat);
 }
 
 MCSOTDMA_Mac::~MCSOTDMA_Mac() {
+	if (trace_event_writer != nullptr) {
+		try {
+			flushTraceEvents();
+		} catch (const std::exception &e) {
+			std::cerr << *this << " couldn't write trace events: " << e.what() << std::endl;
+		}
+		delete trace_event_writer;
+	}
 	for (auto& pair : link_managers)
 		delete pair.second;
 	delete reservation_manager;
+	delete link_proposal_worker_pool;
 }
 
 void MCSOTDMA_Mac::notifyOutgoing(unsigned long num_bits, const MacId& mac_id) {
 	coutd << *this << "::notifyOutgoing(bits=" << num_bits << ", id=" << mac_id << ")... ";	
+	if (mac_id == id)
+		return;
+	LinkManager *link_manager = getLinkManager(mac_id);
+	link_manager->reportOutgoingBits(num_bits);
 	// tell the manager about new data
-	if (mac_id != id)
-		getLinkManager(mac_id)->notifyOutgoing(num_bits);
+	if (!coalesce_outgoing_notifications)
+		link_manager->notifyOutgoing(num_bits);
+	// or sum it up until this slot's notifications are processed
+	else {
+		auto it = std::find_if(outgoing_notifications.begin(), outgoing_notifications.end(), [&mac_id](const std::pair<MacId, unsigned long> &notification) {return notification.first == mac_id;});
+		if (it == outgoing_notifications.end())
+			outgoing_notifications.push_back({mac_id, num_bits});
+		else
+			it->second += num_bits;
+		coutd << "deferred -> ";
+	}
+}
+
+void MCSOTDMA_Mac::processOutgoingNotifications() {
+	if (outgoing_notifications.empty())
+		return;
+	// managers may cause further notifications, which are then kept for the next time
+	std::vector<std::pair<MacId, unsigned long>> notifications;
+	notifications.swap(outgoing_notifications);
+	// links with the largest backlog go first, s.t. their link requests are queued, and their proposals locked, ahead of the others
+	std::stable_sort(notifications.begin(), notifications.end(), [this](const std::pair<MacId, unsigned long> &a, const std::pair<MacId, unsigned long> &b) {
+		return getLinkManager(a.first)->getOutgoingBacklogEstimate() > getLinkManager(b.first)->getOutgoingBacklogEstimate();
+	});
+	for (const auto &notification : notifications) {
+		coutd << *this << " processing " << notification.second << " outgoing bits for id=" << notification.first << " -> ";
+		getLinkManager(notification.first)->notifyOutgoing(notification.second);
+	}
 }
 
 void MCSOTDMA_Mac::passToLower(L2Packet* packet, unsigned int center_frequency) {
@@ -67,21 +108,31 @@ void MCSOTDMA_Mac::passToUpper(L2Packet* packet) {
 }
 
 void MCSOTDMA_Mac::update(uint64_t num_slots) {	
+	PROFILE_PHASE(&slot_profiler, SlotProfiler::mac_update);
 	// Update time.
 	IMac::update(num_slots);
+	ScopedTraceEvent trace_event(trace_event_writer, "update", getCurrentSlot());
 	coutd << "t=" << getCurrentSlot() << " " << *this << "::onSlotStart(" << num_slots << ")... ";
 	// Notify the ReservationManager.
 	assert(reservation_manager && "MCSOTDMA_MAC::onSlotStart with unset ReserationManager.");
-	reservation_manager->update(num_slots);
+	{
+		PROFILE_PHASE(&slot_profiler, SlotProfiler::reservation_table_update);
+		reservation_manager->update(num_slots);
+	}
 	// Notify PHY.
 	assert(lower_layer && "IMac::onSlotStart for unset lower layer.");
 	lower_layer->update(num_slots);
 	// Notify the broadcast channel manager.
-	getLinkManager(SYMBOLIC_LINK_ID_BROADCAST)->onSlotStart(num_slots);
+	{
+		PROFILE_PHASE(&slot_profiler, SlotProfiler::link_manager_on_slot_start);
+		getLinkManager(SYMBOLIC_LINK_ID_BROADCAST)->onSlotStart(num_slots);
+	}
 	// Notify all other LinkManagers.
 	for (auto item : link_managers) {
-		if (item.first != SYMBOLIC_LINK_ID_BROADCAST)
+		if (item.first != SYMBOLIC_LINK_ID_BROADCAST) {
+			PROFILE_PHASE(&slot_profiler, SlotProfiler::link_manager_on_slot_start);
 			item.second->onSlotStart(num_slots);
+		}
 	}
 	// Notify the third-party links.
 	for (auto &item : third_party_links) 
@@ -109,6 +160,10 @@ void MCSOTDMA_Mac::update(uint64_t num_slots) {
 }
 
 std::pair<size_t, size_t> MCSOTDMA_Mac::execute() {
+	PROFILE_PHASE(&slot_profiler, SlotProfiler::mac_execute);
+	ScopedTraceEvent trace_event(trace_event_writer, "execute", getCurrentSlot());
+	// notifications from before this slot's transmissions
+	processOutgoingNotifications();
 	// Fetch all reservations of the current time slot.
 	std::vector<std::pair<Reservation, const FrequencyChannel*>> reservations = reservation_manager->collectCurrentReservations();	
 	size_t num_txs = 0, num_rxs = 0;
@@ -215,8 +270,20 @@ std::pair<size_t, size_t> MCSOTDMA_Mac::execute() {
 	return {num_txs, num_rxs};
 }
 
+std::vector<L2Packet*>& MCSOTDMA_Mac::getReceptionBuffer(uint64_t center_freq) {
+	auto it = std::lower_bound(reception_buffer_frequencies.begin(), reception_buffer_frequencies.end(), center_freq);
+	size_t index = std::distance(reception_buffer_frequencies.begin(), it);
+	// first reception on this channel: add a buffer, which is then reused in all later slots
+	if (it == reception_buffer_frequencies.end() || *it != center_freq) {
+		reception_buffer_frequencies.insert(it, center_freq);
+		reception_buffers.insert(reception_buffers.begin() + index, std::vector<L2Packet*>());
+		reception_buffers.at(index).reserve(reception_buffer_initial_capacity);
+	}
+	return reception_buffers.at(index);
+}
+
 void MCSOTDMA_Mac::storePacket(L2Packet *&packet, uint64_t center_freq) {	
-	received_packets[center_freq].push_back(packet);
+	getReceptionBuffer(center_freq).push_back(packet);
 	coutd << "stored until slot end -> ";
 }
 
@@ -268,21 +335,23 @@ LinkManager* MCSOTDMA_Mac::getLinkManager(const MacId& id) {
 	return link_manager;
 }
 
+uint64_t MCSOTDMA_Mac::getThirdPartyLinkKey(const MacId& id1, const MacId& id2) {
+	// sort the IDs s.t. both orderings map onto the same key
+	const uint32_t id_lo = (uint32_t) std::min(id1.getId(), id2.getId()), id_hi = (uint32_t) std::max(id1.getId(), id2.getId());
+	return (((uint64_t) id_lo) << 32) | ((uint64_t) id_hi);
+}
+
 ThirdPartyLink& MCSOTDMA_Mac::getThirdPartyLink(const MacId& id1, const MacId& id2) {
+	const uint64_t key = getThirdPartyLinkKey(id1, id2);
 	// look for an existing link
-	auto it = third_party_links.find({id1, id2});
-	if (it == third_party_links.end())
-		it = third_party_links.find({id2, id1});	
-	// if found, return it
-	if (it != third_party_links.end()) 
-		return (*it).second;
+	auto it = third_party_links.find(key);
+	if (it != third_party_links.end())
+		return it->second;
 	// else, create one
-	else {
-		auto it_success = third_party_links.emplace(std::piecewise_construct, std::make_tuple(id1, id2), std::make_tuple(id1, id2, this));
-		if (!it_success.second)
-			throw std::runtime_error("couldn't emplace third-party link");		
-		return it_success.first->second;
-	}
+	auto it_success = third_party_links.emplace(std::piecewise_construct, std::make_tuple(key), std::make_tuple(id1, id2, this));
+	if (!it_success.second)
+		throw std::runtime_error("couldn't emplace third-party link");
+	return it_success.first->second;
 }
 
 void MCSOTDMA_Mac::onReceptionSlot(const FrequencyChannel* channel) {
@@ -299,17 +368,21 @@ void MCSOTDMA_Mac::notifyAboutDmeTransmission(uint64_t center_frequency) {
 }
 
 void MCSOTDMA_Mac::onSlotEnd() {
+	PROFILE_PHASE(&slot_profiler, SlotProfiler::mac_on_slot_end);
+	ScopedTraceEvent trace_event(trace_event_writer, "onSlotEnd", getCurrentSlot());
 	size_t num_dropped_packets_this_slot = 0;
 	size_t num_rcvd_packets_this_slot = 0;
 
-	for (auto &packet_freq_pair : received_packets) {
+	for (size_t i = 0; i < reception_buffers.size(); i++) {
 		// On this frequency channel,
-		uint64_t freq = packet_freq_pair.first;
+		uint64_t freq = reception_buffer_frequencies.at(i);
 		// these packets were received.
-		std::vector<L2Packet*> packets = packet_freq_pair.second;		
-		// remove DME packets before processing
-		for (auto it = packets.begin(); it != packets.end();) {
-			auto *packet = *it;
+		std::vector<L2Packet*> &packets = reception_buffers.at(i);
+		if (packets.empty())
+			continue;
+		// remove DME packets before processing, compacting the buffer in-place
+		size_t num_kept = 0;
+		for (auto *packet : packets) {
 			if (packet->isDME()) {							
 				// remember on which channel 
 				if (learn_dme_activity) {
@@ -317,11 +390,11 @@ void MCSOTDMA_Mac::onSlotEnd() {
 				}
 				this->deletePacket(packet);
 				delete packet;
-				it = packets.erase(it);
 				stat_num_dme_packets_rcvd.increment();
 			} else
-				it++;
-		} 
+				packets[num_kept++] = packet;
+		}
+		packets.resize(num_kept);
 		
 		// single packets
 		if (packets.size() == 1) {
@@ -329,13 +402,14 @@ void MCSOTDMA_Mac::onSlotEnd() {
 			// might have a channel error
 			if (packet->hasChannelError) {
 				coutd << *this << " dropping packet due to channel error -> ";
+				trace_ring_buffer.record(TraceRingBuffer::packet_channel_error, getCurrentSlot(), freq, packet->getOrigin().getId());
 				this->deletePacket(packet);
 				delete packet;
-				packets.erase(packets.begin());
 				stat_num_channel_errors.increment();
 			// otherwise they're received
 			} else {
 				coutd << *this << " processing packet -> ";				
+				trace_ring_buffer.record(TraceRingBuffer::packet_received, getCurrentSlot(), packet->getOrigin().getId(), packet->getDestination().getId(), freq);
 				try {
 					reportNeighborActivity(packet->getOrigin());
 					if (packet->getDestination() == SYMBOLIC_LINK_ID_BROADCAST || packet->getDestination() == SYMBOLIC_LINK_ID_BEACON)
@@ -354,6 +428,7 @@ void MCSOTDMA_Mac::onSlotEnd() {
 		} else if (packets.size() > 1) {			
 			coutd << *this << " collision on frequency " << freq << " -> dropping " << packets.size() - 1 << " packets -> ";
 			stat_num_packet_collisions.increment();
+			trace_ring_buffer.record(TraceRingBuffer::packet_collision, getCurrentSlot(), freq, packets.size());
 			// figure out which packet to keep
 			// by comparing SINRs
 			L2Packet *packet_with_largest_snr = nullptr;
@@ -367,6 +442,7 @@ void MCSOTDMA_Mac::onSlotEnd() {
 
 			if (packet_with_largest_snr != nullptr) {
 				coutd << *this << " processing packet with largest SNR -> ";				
+				trace_ring_buffer.record(TraceRingBuffer::packet_received, getCurrentSlot(), packet_with_largest_snr->getOrigin().getId(), packet_with_largest_snr->getDestination().getId(), freq);
 				try {
 					reportNeighborActivity(packet_with_largest_snr->getOrigin());
 					if (packet_with_largest_snr->getDestination() == SYMBOLIC_LINK_ID_BROADCAST || packet_with_largest_snr->getDestination() == SYMBOLIC_LINK_ID_BEACON)
@@ -390,13 +466,20 @@ void MCSOTDMA_Mac::onSlotEnd() {
 				}
             }
         }
+		// keep the buffer's capacity for the next slot
+		packets.clear();
 	}
-	received_packets.clear();
+
+	// notifications from after this slot's transmissions, e.g. triggered by receptions, are processed before the link managers conclude the slot
+	processOutgoingNotifications();
 
 	// update link managers
 	try {
-		for (auto item : link_managers)
+		for (auto item : link_managers) {
+			PROFILE_PHASE(&slot_profiler, SlotProfiler::link_manager_on_slot_end);
 			item.second->onSlotEnd();
+			item.second->updateOutgoingTrafficEstimate();
+		}
 	} catch (const std::exception &e) {
 		std::stringstream ss;
 		ss << *this << "::onSlotEnd error updating link managers: " << e.what() << std::endl;		
@@ -405,8 +488,16 @@ void MCSOTDMA_Mac::onSlotEnd() {
 
 	// update third-party links
 	try {
-		for (auto &item : third_party_links)
-			item.second.onSlotEnd();
+		for (auto it = third_party_links.begin(); it != third_party_links.end();) {
+			auto &third_party_link = it->second;
+			third_party_link.onSlotEnd();
+			// remove links that have been idle for too long
+			if (third_party_link.getStatus() == ThirdPartyLink::uninitialized && third_party_link.getNumIdleSlots() >= third_party_link_idle_timeout) {
+				coutd << *this << " removing idle " << third_party_link << " -> ";
+				it = third_party_links.erase(it);
+			} else
+				it++;
+		}
 	} catch (const std::exception &e) {
 		std::stringstream ss;
 		ss << *this << "::onSlotEnd error updating third party links: " << e.what() << std::endl;		
@@ -434,8 +525,7 @@ void MCSOTDMA_Mac::onSlotEnd() {
 	} 
 
 	// Statistics reporting.
-	for (auto* stat : statistics)
-		stat->update();	
+	statistic_registry.update(1);
 }
 
 const MCSOTDMA_Phy* MCSOTDMA_Mac::getPhy() const {
@@ -458,6 +548,10 @@ void MCSOTDMA_Mac::setBcSlotSelectionMaxNumCandidateSlots(int value) {
 	((SHLinkManager*) getLinkManager(SYMBOLIC_LINK_ID_BROADCAST))->setMaxNumCandidateSlots(value);
 }
 
+const std::vector<unsigned int>& MCSOTDMA_Mac::getBroadcastCandidateSlotTable(size_t max_num_neighbors) {
+	return ((SHLinkManager*) getLinkManager(SYMBOLIC_LINK_ID_BROADCAST))->getCandidateSlotTable(max_num_neighbors);
+}
+
 void MCSOTDMA_Mac::setContentionMethod(ContentionMethod method) {
 	((SHLinkManager*) getLinkManager(SYMBOLIC_LINK_ID_BROADCAST))->setUseContentionMethod(method);
 }
@@ -506,12 +600,44 @@ void MCSOTDMA_Mac::setAdvertiseNextBroadcastSlotInCurrentHeader(bool flag) {
 }
 
 void MCSOTDMA_Mac::onThirdPartyLinkReset(const ThirdPartyLink* caller) {
-	for (auto &pair : third_party_links) {
-		auto &third_party_link = pair.second;
-		if (third_party_link != *caller) {
-			third_party_link.onAnotherThirdLinkReset();
-		}
+	// collect those links that are interested in any of the freed resources
+	const uint64_t current_slot = getCurrentSlot();
+	std::vector<ThirdPartyLink*> affected_links;
+	for (const auto &resource : caller->getFreedResources()) {
+		auto it = third_party_link_resource_index.find({resource.first, current_slot + resource.second});
+		if (it == third_party_link_resource_index.end())
+			continue;
+		for (auto *link : it->second)
+			if (link != caller && std::find(affected_links.begin(), affected_links.end(), link) == affected_links.end())
+				affected_links.push_back(link);
 	}
+	// notify them in the same order as a full iteration over all links would
+	std::sort(affected_links.begin(), affected_links.end(), [](const ThirdPartyLink *a, const ThirdPartyLink *b) {
+		return getThirdPartyLinkKey(a->getIdLinkInitiator(), a->getIdLinkRecipient()) < getThirdPartyLinkKey(b->getIdLinkInitiator(), b->getIdLinkRecipient());
+	});
+	for (auto *third_party_link : affected_links)
+		third_party_link->onAnotherThirdLinkReset();
+}
+
+void MCSOTDMA_Mac::addToThirdPartyLinkIndex(const std::pair<const ReservationTable*, uint64_t>& resource, ThirdPartyLink *link) {
+	third_party_link_resource_index[resource].insert(link);
+}
+
+void MCSOTDMA_Mac::removeFromThirdPartyLinkIndex(const std::pair<const ReservationTable*, uint64_t>& resource, ThirdPartyLink *link) {
+	auto it = third_party_link_resource_index.find(resource);
+	if (it == third_party_link_resource_index.end())
+		return;
+	it->second.erase(link);
+	if (it->second.empty())
+		third_party_link_resource_index.erase(it);
+}
+
+void MCSOTDMA_Mac::setThirdPartyLinkIdleTimeout(unsigned int value) {
+	this->third_party_link_idle_timeout = value;
+}
+
+size_t MCSOTDMA_Mac::getNumThirdPartyLinks() const {
+	return third_party_links.size();
 }
 
 bool MCSOTDMA_Mac::isGoingToTransmitDuringCurrentSlot(uint64_t center_frequency) const {
@@ -570,21 +696,97 @@ bool MCSOTDMA_Mac::shouldLearnDmeActivity() const {
 }
 
 std::pair<std::vector<double>, std::vector<int>> MCSOTDMA_Mac::getUsedPPDutyCycleBudget() const {
-	std::pair<std::vector<double>, std::vector<int>> contributions;	
-	std::vector<double> &used_pp_duty_cycle_budget = contributions.first;
-	std::vector<int> &timeouts = contributions.second;
-	for (const auto &pair : link_managers) {
-		const MacId &id = pair.first;
-		const auto *link_manager = pair.second;		
-		if (id != SYMBOLIC_LINK_ID_BROADCAST && id != SYMBOLIC_LINK_ID_BEACON && id != SYMBOLIC_LINK_ID_DME) {			
-			const auto *pp = (PPLinkManager*) link_manager;
-			if (pp->isActive()) {				
-				used_pp_duty_cycle_budget.push_back(link_manager->getNumTxPerTimeSlot());
-				timeouts.push_back(pp->getRemainingTimeout());
-			}
-		}		
-	}
-	return contributions;
+	return pp_duty_cycle_budget.toVectors();
+}
+
+PPDutyCycleBudget& MCSOTDMA_Mac::getPPDutyCycleBudget() {
+	return pp_duty_cycle_budget;
+}
+
+const PPDutyCycleBudget& MCSOTDMA_Mac::getPPDutyCycleBudget() const {
+	return pp_duty_cycle_budget;
+}
+
+void MCSOTDMA_Mac::setStatisticsEmissionInterval(unsigned int value) {
+	statistic_registry.setEmissionInterval(value);
+}
+
+const StatisticRegistry& MCSOTDMA_Mac::getStatisticRegistry() const {
+	return statistic_registry;
+}
+
+const LatencyHistogram& MCSOTDMA_Mac::getBroadcastMacDelayHistogram() const {
+	return histogram_broadcast_mac_delay;
+}
+
+const LatencyHistogram& MCSOTDMA_Mac::getUnicastMacDelayHistogram() const {
+	return histogram_unicast_mac_delay;
+}
+
+const LatencyHistogram& MCSOTDMA_Mac::getPPLinkEstablishmentTimeHistogram() const {
+	return histogram_pp_link_establishment_time;
+}
+
+const LatencyHistogram& MCSOTDMA_Mac::getAvgBeaconReceptionDelayHistogram() const {
+	return histogram_avg_beacon_rx_delay;
+}
+
+SlotProfiler& MCSOTDMA_Mac::getSlotProfiler() {
+	return slot_profiler;
+}
+
+void MCSOTDMA_Mac::setParallelLinkProposalSearch(unsigned int num_threads, size_t min_num_searches) {
+	delete link_proposal_worker_pool;
+	link_proposal_worker_pool = num_threads > 0 ? new WorkerPool(num_threads) : nullptr;
+	min_num_parallel_link_proposal_searches = min_num_searches;
+}
+
+void MCSOTDMA_Mac::setCoalesceOutgoingNotifications(bool value) {
+	coalesce_outgoing_notifications = value;
+	if (!coalesce_outgoing_notifications)
+		processOutgoingNotifications();
+}
+
+bool MCSOTDMA_Mac::shouldCoalesceOutgoingNotifications() const {
+	return coalesce_outgoing_notifications;
+}
+
+WorkerPool* MCSOTDMA_Mac::getLinkProposalWorkerPool() {
+	return link_proposal_worker_pool;
+}
+
+size_t MCSOTDMA_Mac::getMinNumParallelLinkProposalSearches() const {
+	return min_num_parallel_link_proposal_searches;
+}
+
+void MCSOTDMA_Mac::enableTraceEvents(const std::string& filename, size_t max_num_events) {
+	delete trace_event_writer;
+	trace_event_writer = new TraceEventWriter(id.getId(), max_num_events);
+	trace_event_filename = filename;
+}
+
+void MCSOTDMA_Mac::flushTraceEvents() {
+	if (trace_event_writer == nullptr)
+		throw std::runtime_error("MCSOTDMA_Mac::flushTraceEvents when trace events are disabled.");
+	trace_event_writer->flush(trace_event_filename);
+}
+
+TraceEventWriter* MCSOTDMA_Mac::getTraceEventWriter() {
+	return trace_event_writer;
+}
+
+void MCSOTDMA_Mac::traceLinkMilestone(const char *name, const MacId& id1, const MacId& id2, TraceRingBuffer::Event event, int64_t arg1, int64_t arg2, int64_t arg3) {
+	if (trace_event_writer != nullptr)
+		trace_event_writer->instant(name, getCurrentSlot(), id1.getId(), id2.getId());
+	trace_ring_buffer.record(event, getCurrentSlot(), arg1, arg2, arg3);
+}
+
+void MCSOTDMA_Mac::setTracingEnabled(bool value) {
+	trace_ring_buffer.setEnabled(value);
+}
+
+TraceRingBuffer& MCSOTDMA_Mac::getTraceRingBuffer() {
+	return trace_ring_buffer;
 }
 
 size_t MCSOTDMA_Mac::getNumActivePPLinks() const {
@@ -657,6 +859,14 @@ bool MCSOTDMA_Mac::shouldConsiderDutyCycle() const {
 	return this->use_duty_cycle;
 }
 
+void MCSOTDMA_Mac::setUseDutyCycleForecast(bool flag) {
+	this->use_duty_cycle_forecast = flag;
+}
+
+bool MCSOTDMA_Mac::shouldUseDutyCycleForecast() const {
+	return this->use_duty_cycle_forecast;
+}
+
 void MCSOTDMA_Mac::setMinNumSupportedPPLinks(unsigned int value) {
 	this->duty_cycle.setMinNumSupportedPPLinks(value);
 }
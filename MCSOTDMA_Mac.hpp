@@ -23,12 +23,19 @@
 #include <IOmnetPluggable.hpp>
 #include <Statistic.hpp>
 #include <ContentionMethod.hpp>
+#include <set>
 #include "ReservationManager.hpp"
 #include "LinkManager.hpp"
 #include "MCSOTDMA_Phy.hpp"
 #include "NeighborObserver.hpp"
 #include "ThirdPartyLink.hpp"
 #include "DutyCycle.hpp"
+#include "StatisticRegistry.hpp"
+#include "LatencyHistogram.hpp"
+#include "SlotProfiler.hpp"
+#include "TraceEventWriter.hpp"
+#include "TraceRingBuffer.hpp"
+#include "WorkerPool.hpp"
 
 
 namespace TUHH_INTAIRNET_MCSOTDMA {
@@ -92,6 +99,8 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		void setBcSlotSelectionMinNumCandidateSlots(int value) override;
 		void setBcSlotSelectionMaxNumCandidateSlots(int value) override;
 		void setContentionMethod(ContentionMethod method) override;		
+		/** @return The broadcast slot selection's number of candidate slots, indexed by the number of active neighbors. See SHLinkManager::getCandidateSlotTable. */
+		const std::vector<unsigned int>& getBroadcastCandidateSlotTable(size_t max_num_neighbors);
 		void setAdvertiseNextBroadcastSlotInCurrentHeader(bool flag) override;				
 		void setMaxNoPPLinkEstablishmentAttempts(int value) override;
 		void setMinNumSupportedPPLinks(unsigned int value) override;
@@ -104,7 +113,16 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		const std::map<MacId, LinkManager*>& getLinkManagers() const;
 
 
+		/** Notifies those ThirdPartyLinks whose resources overlap with the ones just freed by 'caller'. */
 		void onThirdPartyLinkReset(const ThirdPartyLink* caller);
+		/** ThirdPartyLinks register the resources they are interested in, s.t. they are notified when another link frees any of them. */
+		void addToThirdPartyLinkIndex(const std::pair<const ReservationTable*, uint64_t>& resource, ThirdPartyLink *link);
+		void removeFromThirdPartyLinkIndex(const std::pair<const ReservationTable*, uint64_t>& resource, ThirdPartyLink *link);
+		/**
+		 * @param value Number of slots after which an uninitialized ThirdPartyLink is removed.
+		 */
+		void setThirdPartyLinkIdleTimeout(unsigned int value);
+		size_t getNumThirdPartyLinks() const;
 
 		virtual bool isGoingToTransmitDuringCurrentSlot(uint64_t center_frequency) const;
 
@@ -168,9 +186,11 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 */
 		void statisticReportBroadcastMacDelay(unsigned int mac_delay) {			
 			stat_broadcast_mac_delay.capture((double) mac_delay);
+			histogram_broadcast_mac_delay.record((double) mac_delay);
 		}
 		void statisticReportAvgBeaconReceptionDelay(double avg_delay) {
 			stat_avg_beacon_rx_delay.capture(avg_delay);
+			histogram_avg_beacon_rx_delay.record(avg_delay);
 		}
 		void statisticReportFirstNeighborAvgBeaconReceptionDelay(double avg_delay) {
 			stat_first_neighbor_beacon_rx_delay.capture(avg_delay);
@@ -178,6 +198,7 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 
 		void statisticReportUnicastMacDelay(unsigned int mac_delay) {			
 			stat_unicast_mac_delay.capture((double) mac_delay);
+			histogram_unicast_mac_delay.record((double) mac_delay);
 		}		
 
 		void statisticReportPPLinkMissedLastReplyOpportunity() {
@@ -189,6 +210,7 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 */
 		void statisticReportPPLinkEstablishmentTime(unsigned int num_slots) {
 			stat_pp_link_establishment_time.capture(num_slots);
+			histogram_pp_link_establishment_time.record((double) num_slots);
 		}		
 
 		void statisticReportPPLinkEstablished() {
@@ -236,6 +258,11 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		const DutyCycle& getDutyCycle() const;
 		void setConsiderDutyCycle(bool flag) override;
 		bool shouldConsiderDutyCycle() const;
+		/**
+		 * @param flag Whether duty cycle admission should count the transmissions already scheduled in future windows, instead of relying on per-link averages only.
+		 */
+		void setUseDutyCycleForecast(bool flag);
+		bool shouldUseDutyCycleForecast() const;
 
 		bool shouldLearnDmeActivity() const;
 
@@ -249,12 +276,59 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 * @return <used budget per link, timeout per link>
 		 */
 		std::pair<std::vector<double>, std::vector<int>> getUsedPPDutyCycleBudget() const;		
+		/** @return Running aggregate of the duty cycle budget used by active PP links, which PPLinkManagers keep up-to-date. */
+		PPDutyCycleBudget& getPPDutyCycleBudget();
+		const PPDutyCycleBudget& getPPDutyCycleBudget() const;
 		double getUsedSHDutyCycleBudget() const;		
 		int getSHSlotOffset() const; 
 		int getDefaultPPLinkTimeout() const;
 		bool shouldUseFixedPPPeriod() const;
 		int getFixedPPPeriod() const;
 		size_t getNumActivePPLinks() const;		
+		/**
+		 * @param value Number of slots between two emissions of those statistics that have changed.
+		 */
+		void setStatisticsEmissionInterval(unsigned int value);
+		const StatisticRegistry& getStatisticRegistry() const;
+		/** Histograms of all reported values, which can be queried for quantiles and merged across users. All values are in time slots. */
+		const LatencyHistogram& getBroadcastMacDelayHistogram() const;
+		const LatencyHistogram& getUnicastMacDelayHistogram() const;
+		const LatencyHistogram& getPPLinkEstablishmentTimeHistogram() const;
+		const LatencyHistogram& getAvgBeaconReceptionDelayHistogram() const;
+		/** Holds the time spent in each slot phase. Only filled if compiled with MCSOTDMA_PROFILING. */
+		SlotProfiler& getSlotProfiler();
+		/**
+		 * Lets LinkProposalFinder search several channels concurrently, with the same results as a sequential search.
+		 * @param num_threads Number of worker threads in addition to the calling one. 0 disables parallel searches.
+		 * @param min_num_searches Searches over fewer channel-period pairs run sequentially, as dispatching them wouldn't pay off.
+		 */
+		void setParallelLinkProposalSearch(unsigned int num_threads, size_t min_num_searches = 8);
+		/**
+		 * @param value Whether notifyOutgoing() should only sum up the bits per destination, s.t. each link manager is notified once at the start of execute() and once before the link managers' onSlotEnd(), in order of their LinkManager::getOutgoingBacklogEstimate(). Disabling it processes pending notifications right away.
+		 */
+		void setCoalesceOutgoingNotifications(bool value);
+		bool shouldCoalesceOutgoingNotifications() const;
+		/** @return Worker pool for link proposal searches, or nullptr if parallel searches are disabled. */
+		WorkerPool* getLinkProposalWorkerPool();
+		size_t getMinNumParallelLinkProposalSearches() const;
+		/**
+		 * Starts buffering trace events of slot phases and link milestones.
+		 * @param filename They are written to this file in the Chrome trace event format when flushTraceEvents() is called or this MAC is destroyed.
+		 * @param max_num_events Later events are dropped.
+		 */
+		void enableTraceEvents(const std::string& filename, size_t max_num_events = 1000000);
+		void flushTraceEvents();
+		/** @return The trace event writer, or nullptr if trace events are disabled. */
+		TraceEventWriter* getTraceEventWriter();
+		/** Records a link milestone as an instant trace event between id1 and id2 if trace events are enabled, and as a binary trace record with the given arguments if tracing is enabled. */
+		void traceLinkMilestone(const char *name, const MacId& id1, const MacId& id2, TraceRingBuffer::Event event, int64_t arg1, int64_t arg2 = 0, int64_t arg3 = 0);
+		/**
+		 * Switches the binary trace of packet receptions, slot selections and link events on or off.
+		 * Unlike coutd, this works in production builds and can be enabled for single users.
+		 */
+		void setTracingEnabled(bool value);
+		/** @return The binary trace, which can be dumped in readable form. */
+		TraceRingBuffer& getTraceRingBuffer();
 
 	protected:
 		/**
@@ -263,16 +337,31 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 */
 		void onReceptionSlot(const FrequencyChannel* channel);
 		void storePacket(L2Packet *&packet, uint64_t center_freq);
+		/** @return The reception buffer of the given channel, which is created upon first use. */
+		std::vector<L2Packet*>& getReceptionBuffer(uint64_t center_freq);
+		/** @return A key that is identical for (id1, id2) and (id2, id1). */
+		static uint64_t getThirdPartyLinkKey(const MacId& id1, const MacId& id2);
+		/** Passes the summed bits of coalesced notifyOutgoing() calls to the link managers. */
+		void processOutgoingNotifications();
 
 		/** Keeps track of transmission resource reservations. */
 		ReservationManager* reservation_manager;
 		/** Maps links to their link managers. */
 		std::map<MacId, LinkManager*> link_managers;
-		std::map<std::pair<MacId, MacId>, ThirdPartyLink> third_party_links;
+		/** Maps <table, absolute time slot> to those ThirdPartyLinks that are interested in this resource. Declared before 'third_party_links' as these unregister themselves upon destruction. */
+		std::map<std::pair<const ReservationTable*, uint64_t>, std::set<ThirdPartyLink*>> third_party_link_resource_index;
+		/** Maps an order-insensitive key of both link partners' IDs to the ThirdPartyLink, s.t. links are iterated sorted by (lower ID, higher ID). References remain valid as links are added. */
+		std::map<uint64_t, ThirdPartyLink> third_party_links;
+		/** Number of slots after which an uninitialized ThirdPartyLink is removed. Defaults to the planning horizon. */
+		unsigned int third_party_link_idle_timeout;
 		const size_t num_transmitters = 1, num_receivers = 2;
 		/** Holds the current belief of neighbor positions. */
 		std::map<MacId, CPRPosition> position_map;
-		std::map<uint64_t, std::vector<L2Packet*>> received_packets;		
+		/** Sorted center frequencies of those channels that packets have been received on. */
+		std::vector<uint64_t> reception_buffer_frequencies;
+		/** Packets received during the current slot, indexed like 'reception_buffer_frequencies'. Buffers are cleared at the end of each slot but keep their capacity. */
+		std::vector<std::vector<L2Packet*>> reception_buffers;
+		const size_t reception_buffer_initial_capacity = 4;
 		/** Keeps a list of active neighbors, which have demonstrated activity within the last 50.000 slots (10min if slot duration is 12ms). */
 		NeighborObserver neighbor_observer; 
 		/** Number of transmission bursts before a P2P link expires. */
@@ -282,6 +371,7 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		unsigned int pp_link_burst_offset = 20;
 		bool adapt_burst_offset = true;
 		bool use_duty_cycle = true;
+		bool use_duty_cycle_forecast = false;
 		int default_pp_link_timeout = 20;
 				
 		/** Percentage of time that can be used for transmissions. */
@@ -291,6 +381,7 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		/** Number of PP links that the MAC should be able to maintain, given the maximum duty cycle. */
 		const unsigned int default_min_num_supported_pp_links = 1;
 		DutyCycle duty_cycle;
+		PPDutyCycleBudget pp_duty_cycle_budget;
 
 		bool learn_dme_activity = false;
 		std::map<uint64_t, bool> channel_sensing_observation;	
@@ -306,49 +397,49 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		size_t num_sent_packets_this_slot = 0;		
 
 		// Statistics
-		Statistic stat_num_packets_rcvd = Statistic("mcsotdma_statistic_num_packets_received", this);
-		Statistic stat_num_broadcasts_rcvd = Statistic("mcsotdma_statistic_num_broadcasts_received", this);
-		Statistic stat_num_broadcast_msgs_processed = Statistic("mcsotdma_statistic_num_broadcast_message_processed", this);
-		Statistic stat_num_unicasts_rcvd = Statistic("mcsotdma_statistic_num_unicasts_received", this);
-		Statistic stat_num_unicast_msgs_processed = Statistic("mcsotdma_statistic_num_unicast_message_processed", this);
-		Statistic stat_num_requests_rcvd = Statistic("mcsotdma_statistic_num_link_requests_received", this);
-		Statistic stat_num_third_party_requests_rcvd = Statistic("mcsotdma_statistic_num_third_party_link_requests_received", this);
-		Statistic stat_num_replies_rcvd = Statistic("mcsotdma_statistic_num_link_replies_received", this);
-		Statistic stat_num_third_party_replies_rcvd = Statistic("mcsotdma_statistic_num_third_party_replies_rcvd", this);		
-		Statistic stat_num_packets_sent = Statistic("mcsotdma_statistic_num_packets_sent", this);
-		Statistic stat_num_requests_sent = Statistic("mcsotdma_statistic_num_link_requests_sent", this);		
-		Statistic stat_num_broadcasts_sent = Statistic("mcsotdma_statistic_num_broadcasts_sent", this);
-		Statistic stat_num_unicasts_sent = Statistic("mcsotdma_statistic_num_unicasts_sent", this);
-		Statistic stat_num_replies_sent = Statistic("mcsotdma_statistic_num_link_replies_sent", this);				
-		Statistic stat_num_packet_collisions = Statistic("mcsotdma_statistic_num_packet_collisions", this);
-		Statistic stat_dropped_packets_this_slot = Statistic("mcsotdma_statistic_dropped_packets_this_slot", this);
-		Statistic stat_sent_packets_this_slot = Statistic("mcsotdma_statistic_sent_packets_this_slot", this);
-		Statistic stat_rcvd_packets_this_slot = Statistic("mcsotdma_statistic_rcvd_packets_this_slot", this);
-		Statistic stat_num_channel_errors = Statistic("mcsotdma_statistic_num_channel_errors", this);		
-		Statistic stat_num_active_neighbors = Statistic("mcsotdma_statistic_num_active_neighbors", this);		
-		Statistic stat_broadcast_candidate_slots = Statistic("mcsotdma_statistic_broadcast_candidate_slots", this);
-		Statistic stat_broadcast_selected_candidate_slots = Statistic("mcsotdma_statistic_broadcast_selected_candidate_slot", this);		
-		Statistic stat_broadcast_mac_delay = Statistic("mcsotdma_statistic_broadcast_mac_delay", this);
-		Statistic stat_avg_beacon_rx_delay = Statistic("mcsotdma_statistic_avg_beacon_rx_delay", this);
-		Statistic stat_first_neighbor_beacon_rx_delay = Statistic("mcsotdma_statistic_first_neighbor_beacon_rx_delay", this);
-		Statistic stat_unicast_mac_delay = Statistic("mcsotdma_statistic_unicast_mac_delay", this);								
-		Statistic stat_pp_link_missed_last_reply_opportunity = Statistic("mcsotdma_statistic_pp_link_missed_last_reply_opportunity", this);		
-		Statistic stat_pp_link_exceeded_max_no_establishment_attempts = Statistic("mcsotdma_statistic_pp_link_exceeded_max_no_establishment_attempts", this);
-		Statistic stat_pp_link_establishment_time = Statistic("mcsotdma_statistic_pp_link_establishment_time", this);						
-		Statistic stat_num_pp_links_established = Statistic("mcsotdma_statistic_num_pp_links_established", this);
-		Statistic stat_num_pp_link_requests_accepted = Statistic("mcsotdma_statistic_pp_link_requests_accepted", this);
-		Statistic stat_num_pp_links_expired = Statistic("mcsotdma_statistic_num_pp_links_expired", this);		
+		TrackedStatistic stat_num_packets_rcvd = TrackedStatistic("mcsotdma_statistic_num_packets_received", this);
+		TrackedStatistic stat_num_broadcasts_rcvd = TrackedStatistic("mcsotdma_statistic_num_broadcasts_received", this);
+		TrackedStatistic stat_num_broadcast_msgs_processed = TrackedStatistic("mcsotdma_statistic_num_broadcast_message_processed", this);
+		TrackedStatistic stat_num_unicasts_rcvd = TrackedStatistic("mcsotdma_statistic_num_unicasts_received", this);
+		TrackedStatistic stat_num_unicast_msgs_processed = TrackedStatistic("mcsotdma_statistic_num_unicast_message_processed", this);
+		TrackedStatistic stat_num_requests_rcvd = TrackedStatistic("mcsotdma_statistic_num_link_requests_received", this);
+		TrackedStatistic stat_num_third_party_requests_rcvd = TrackedStatistic("mcsotdma_statistic_num_third_party_link_requests_received", this);
+		TrackedStatistic stat_num_replies_rcvd = TrackedStatistic("mcsotdma_statistic_num_link_replies_received", this);
+		TrackedStatistic stat_num_third_party_replies_rcvd = TrackedStatistic("mcsotdma_statistic_num_third_party_replies_rcvd", this);		
+		TrackedStatistic stat_num_packets_sent = TrackedStatistic("mcsotdma_statistic_num_packets_sent", this);
+		TrackedStatistic stat_num_requests_sent = TrackedStatistic("mcsotdma_statistic_num_link_requests_sent", this);		
+		TrackedStatistic stat_num_broadcasts_sent = TrackedStatistic("mcsotdma_statistic_num_broadcasts_sent", this);
+		TrackedStatistic stat_num_unicasts_sent = TrackedStatistic("mcsotdma_statistic_num_unicasts_sent", this);
+		TrackedStatistic stat_num_replies_sent = TrackedStatistic("mcsotdma_statistic_num_link_replies_sent", this);				
+		TrackedStatistic stat_num_packet_collisions = TrackedStatistic("mcsotdma_statistic_num_packet_collisions", this);
+		TrackedStatistic stat_dropped_packets_this_slot = TrackedStatistic("mcsotdma_statistic_dropped_packets_this_slot", this);
+		TrackedStatistic stat_sent_packets_this_slot = TrackedStatistic("mcsotdma_statistic_sent_packets_this_slot", this);
+		TrackedStatistic stat_rcvd_packets_this_slot = TrackedStatistic("mcsotdma_statistic_rcvd_packets_this_slot", this);
+		TrackedStatistic stat_num_channel_errors = TrackedStatistic("mcsotdma_statistic_num_channel_errors", this);		
+		TrackedStatistic stat_num_active_neighbors = TrackedStatistic("mcsotdma_statistic_num_active_neighbors", this);		
+		TrackedStatistic stat_broadcast_candidate_slots = TrackedStatistic("mcsotdma_statistic_broadcast_candidate_slots", this);
+		TrackedStatistic stat_broadcast_selected_candidate_slots = TrackedStatistic("mcsotdma_statistic_broadcast_selected_candidate_slot", this);		
+		TrackedStatistic stat_broadcast_mac_delay = TrackedStatistic("mcsotdma_statistic_broadcast_mac_delay", this);
+		TrackedStatistic stat_avg_beacon_rx_delay = TrackedStatistic("mcsotdma_statistic_avg_beacon_rx_delay", this);
+		TrackedStatistic stat_first_neighbor_beacon_rx_delay = TrackedStatistic("mcsotdma_statistic_first_neighbor_beacon_rx_delay", this);
+		TrackedStatistic stat_unicast_mac_delay = TrackedStatistic("mcsotdma_statistic_unicast_mac_delay", this);								
+		TrackedStatistic stat_pp_link_missed_last_reply_opportunity = TrackedStatistic("mcsotdma_statistic_pp_link_missed_last_reply_opportunity", this);		
+		TrackedStatistic stat_pp_link_exceeded_max_no_establishment_attempts = TrackedStatistic("mcsotdma_statistic_pp_link_exceeded_max_no_establishment_attempts", this);
+		TrackedStatistic stat_pp_link_establishment_time = TrackedStatistic("mcsotdma_statistic_pp_link_establishment_time", this);						
+		TrackedStatistic stat_num_pp_links_established = TrackedStatistic("mcsotdma_statistic_num_pp_links_established", this);
+		TrackedStatistic stat_num_pp_link_requests_accepted = TrackedStatistic("mcsotdma_statistic_pp_link_requests_accepted", this);
+		TrackedStatistic stat_num_pp_links_expired = TrackedStatistic("mcsotdma_statistic_num_pp_links_expired", this);		
 		/** If proposed resources are earlier than the next SH transmission. */
-		Statistic stat_num_pp_requests_rejected_due_to_unacceptable_reply_slot = Statistic("mcsotdma_statistic_num_pp_requests_rejected_due_to_unacceptable_reply_slot", this);
-		Statistic stat_num_pp_requests_rejected_due_to_unacceptable_pp_resource_proposals = Statistic("mcsotdma_statistic_num_pp_requests_rejected_due_to_unacceptable_pp_resource_proposals", this);				
-		Statistic stat_pp_period = Statistic("mcsotdma_statistic_pp_period", this);				
-		Statistic stat_num_dme_packets_rcvd = Statistic("mcsotdma_statistic_num_num_dme_packets_rcvd", this);		
-		Statistic stat_num_broadcast_collisions_detected = Statistic("mcsotdma_statistic_num_broadcast_collisions_detected", this);				
+		TrackedStatistic stat_num_pp_requests_rejected_due_to_unacceptable_reply_slot = TrackedStatistic("mcsotdma_statistic_num_pp_requests_rejected_due_to_unacceptable_reply_slot", this);
+		TrackedStatistic stat_num_pp_requests_rejected_due_to_unacceptable_pp_resource_proposals = TrackedStatistic("mcsotdma_statistic_num_pp_requests_rejected_due_to_unacceptable_pp_resource_proposals", this);				
+		TrackedStatistic stat_pp_period = TrackedStatistic("mcsotdma_statistic_pp_period", this);				
+		TrackedStatistic stat_num_dme_packets_rcvd = TrackedStatistic("mcsotdma_statistic_num_num_dme_packets_rcvd", this);		
+		TrackedStatistic stat_num_broadcast_collisions_detected = TrackedStatistic("mcsotdma_statistic_num_broadcast_collisions_detected", this);				
 		Statistic stat_duty_cycle = Statistic("mcsotdma_statistic_duty_cycle", this);		
 		Statistic stat_num_own_proposals_sent = Statistic("mcsotdma_statistic_num_own_proposals_sent", this);		
 		Statistic stat_num_saved_proposals_sent = Statistic("mcsotdma_statistic_num_saved_proposals_sent", this);		
-		Statistic stat_num_link_utils_rcvd = Statistic("mcsotdma_statistic_num_link_utils_rcvd", this);		
-		std::vector<Statistic*> statistics = {
+		TrackedStatistic stat_num_link_utils_rcvd = TrackedStatistic("mcsotdma_statistic_num_link_utils_rcvd", this);		
+		std::vector<TrackedStatistic*> statistics = {
 				&stat_num_packets_rcvd,
 				&stat_num_broadcasts_rcvd,
 				&stat_num_broadcast_msgs_processed,
@@ -387,6 +478,18 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 				&stat_num_broadcast_collisions_detected,				
 				&stat_num_link_utils_rcvd
 		};
+		/** Emits only those statistics that have changed. */
+		StatisticRegistry statistic_registry;
+		LatencyHistogram histogram_broadcast_mac_delay, histogram_unicast_mac_delay, histogram_pp_link_establishment_time, histogram_avg_beacon_rx_delay;
+		SlotProfiler slot_profiler;
+		WorkerPool *link_proposal_worker_pool = nullptr;
+		size_t min_num_parallel_link_proposal_searches = 8;
+		bool coalesce_outgoing_notifications = false;
+		/** <destination, summed bits> of notifyOutgoing() calls that haven't been passed to the link managers yet, in order of the first call. */
+		std::vector<std::pair<MacId, unsigned long>> outgoing_notifications;
+		TraceEventWriter *trace_event_writer = nullptr;
+		std::string trace_event_filename;
+		TraceRingBuffer trace_ring_buffer;
 	};
 
 	inline std::ostream& operator<<(std::ostream& stream, const MCSOTDMA_Mac& mac) {
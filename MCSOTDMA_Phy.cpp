@@ -26,6 +26,8 @@ MCSOTDMA_Phy::MCSOTDMA_Phy(uint32_t planning_horizon) : transmitter_reservation_
 	receiver_reservation_tables.push_back(new ReservationTable(planning_horizon));
 	// Don't add a BC receiver. This is assumed as always busy.
 //    receiver_reservation_tables.push_back(new ReservationTable(planning_horizon, Reservation(SYMBOLIC_LINK_ID_BROADCAST, Reservation::RX)));
+	for (auto* stat : statistics)
+		statistic_registry.add(stat);
 }
 
 bool MCSOTDMA_Phy::isTransmitterIdle(unsigned int slot_offset, unsigned int num_slots) const {
@@ -51,8 +53,11 @@ void MCSOTDMA_Phy::update(uint64_t num_slots) {
 	for (auto* rx_table : receiver_reservation_tables)
 		rx_table->update(num_slots);
 	// Statistics reporting.
-	for (auto* stat : statistics)
-		stat->update();
+	statistic_registry.update(num_slots);
+}
+
+void MCSOTDMA_Phy::setStatisticsEmissionInterval(unsigned int value) {
+	statistic_registry.setEmissionInterval(value);
 }
 
 ReservationTable* MCSOTDMA_Phy::getTransmitterReservationTable() {
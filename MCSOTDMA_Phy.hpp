@@ -21,6 +21,7 @@
 #include <IOmnetPluggable.hpp>
 #include <Statistic.hpp>
 #include "ReservationTable.hpp"
+#include "StatisticRegistry.hpp"
 
 namespace TUHH_INTAIRNET_MCSOTDMA {
 	class MCSOTDMA_Phy : public IPhy, public IOmnetPluggable {
@@ -47,17 +48,24 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 
 		void onReception(L2Packet* packet, uint64_t center_frequency) override;
 
+		/**
+		 * @param value Number of slots between two emissions of those statistics that have changed.
+		 */
+		void setStatisticsEmissionInterval(unsigned int value);
+
 	protected:
 		/** Is notified by MAC ReservationTables of their reservations. */
 		ReservationTable* transmitter_reservation_table = nullptr;
 		std::vector<ReservationTable*> receiver_reservation_tables;
-		Statistic stat_num_packets_rcvd = Statistic("phy_statistic_num_packets_received", this);
+		TrackedStatistic stat_num_packets_rcvd = TrackedStatistic("phy_statistic_num_packets_received", this);
 		/** Collects the number of packets intended for this user that were missed because no receiver was tuned to the channel. */
-		Statistic stat_num_packets_missed = Statistic("phy_statistic_num_packets_missed", this);
-		std::vector<Statistic*> statistics = {
+		TrackedStatistic stat_num_packets_missed = TrackedStatistic("phy_statistic_num_packets_missed", this);
+		std::vector<TrackedStatistic*> statistics = {
 				&stat_num_packets_rcvd,
 				&stat_num_packets_missed
 		};
+		/** Emits only those statistics that have changed. */
+		StatisticRegistry statistic_registry;
 	};
 }
 
@@ -15,6 +15,8 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <iostream>
+#include <stdexcept>
+#include <string>
 #include "MovingAverage.hpp"
 
 using namespace TUHH_INTAIRNET_MCSOTDMA;
@@ -23,9 +25,12 @@ MovingAverage::MovingAverage(unsigned int num_values) : values(num_values), inde
 MovingAverage::MovingAverage(const MovingAverage& old, unsigned int num_values) : values(num_values), index(0) {
 	// copy as many values as fit
 	for (size_t t = 0; t < std::min((size_t) num_values, (size_t) old.index); t++) {
-		values.at(t) = old.values.at(t);
+		values.at(t) = old.getValue(t);
+		sum += values.at(t);
 		index++;
 	}
+	ewma_alpha = old.ewma_alpha;
+	ewma = old.ewma;
 }
 
 
@@ -33,26 +38,41 @@ void MovingAverage::put(unsigned long value) {
 	has_been_updated = true;
 	if (values.size() == 0)
 		throw std::runtime_error("MovingAverage has size zero, but put has been called.");
+	bool is_first_value = index == 0;
 	// If the window hasn't been filled yet.
 	if (index <= values.size() - 1) {		
 		values.at(index) = value;
 		index++;
-		// If it has, kick out an old value.
+		// If it has, kick out the oldest value.
 	} else {		
-		for (std::size_t i = 1; i < values.size(); i++)
-			values.at(i - 1) = values.at(i);
-		values.at(values.size() - 1) = value;
+		sum -= values.at(head);
+		values.at(head) = value;
+		head = (head + 1) % values.size();
 	}
+	sum += value;
+	if (ewma_alpha > 0.0)
+		ewma = is_first_value ? (double) value : ewma_alpha * value + (1.0 - ewma_alpha) * ewma;
 }
 
 double MovingAverage::get() const {
 	if (index == 0)
 		return 0.0; // No values were recorded yet.
-	double moving_average = 0.0;
-	for (auto it = values.begin(); it < values.end(); it++)
-		moving_average += (*it);
-	// Differentiate between a full window and a non-full window.
-	return index < values.size() ? moving_average / ((double) index) : moving_average / ((double) values.size());
+	if (ewma_alpha > 0.0)
+		return ewma;
+	// index never exceeds the window size
+	return ((double) sum) / ((double) index);
+}
+
+void MovingAverage::setExponentialWeight(double alpha) {
+	if (alpha <= 0.0 || alpha > 1.0)
+		throw std::invalid_argument("MovingAverage::setExponentialWeight for alpha=" + std::to_string(alpha) + " not in (0, 1].");
+	// start from the current window average
+	ewma = get();
+	ewma_alpha = alpha;
+}
+
+unsigned long long MovingAverage::getValue(std::size_t i) const {
+	return values.at((head + i) % values.size());
 }
 
 void MovingAverage::reset() {
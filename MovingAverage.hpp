@@ -21,18 +21,37 @@
 #include <vector>
 
 namespace TUHH_INTAIRNET_MCSOTDMA {
+	/**
+	 * Sliding-window average over the last num_values values.
+	 * Values are kept in a ring buffer together with their running sum, s.t. put() and get() are O(1).
+	 */
 	class MovingAverage {
 
 		friend class LinkManagerTests;
+		friend class MovingAverageTests;
 
 	public:
 		explicit MovingAverage(unsigned int num_values);
+		/**
+		 * Copies as many of the oldest values of 'old' as fit into a window of num_values.
+		 */
 		MovingAverage(const MovingAverage& old, unsigned int num_values);
 
 		void put(unsigned long value);
 
+		/**
+		 * @return The average over the window, or the exponentially-weighted average if that has been enabled.
+		 */
 		double get() const;
 
+		/**
+		 * Switches get() to an exponentially-weighted moving average, which weighs each new value by alpha.
+		 * The window is still filled, s.t. hasReachedNumValues() keeps its meaning.
+		 * @param alpha In (0, 1].
+		 * @throws std::invalid_argument if alpha is out of range.
+		 */
+		void setExponentialWeight(double alpha);
+
 		/**
 		 * @return Whether a call to put() has been made since the last reset().
 		 */
@@ -48,10 +67,21 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 */
 		bool hasReachedNumValues() const;
 
+	protected:
+		/** @return The i-th value in order of insertion, where 0 is the oldest value in the window. */
+		unsigned long long getValue(std::size_t i) const;
+
 	protected:
 		std::vector<unsigned long long> values;
+		/** Number of values in the window. */
 		std::size_t index;
+		/** Position of the oldest value once the window is full. */
+		std::size_t head = 0;
+		unsigned long long sum = 0;
 		bool has_been_updated = false;
+		/** Weight of new values if the exponentially-weighted average is used, 0 otherwise. */
+		double ewma_alpha = 0.0;
+		double ewma = 0.0;
 	};
 }
 
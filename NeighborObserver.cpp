@@ -16,10 +16,14 @@
 
 #include "NeighborObserver.hpp"
 #include <iostream>
+#include <algorithm>
 
 using namespace TUHH_INTAIRNET_MCSOTDMA;
 
-NeighborObserver::NeighborObserver(unsigned int max_time_slots_until_neighbor_not_active_anymore) : max_last_seen_val(max_time_slots_until_neighbor_not_active_anymore), first_neighbor_avg_last_seen(MovingAverage(this->num_time_slots_to_average)) {}
+const unsigned int NeighborObserver::MAX_NUM_EXPIRY_BUCKETS;
+const size_t NeighborObserver::MAX_NUM_ADVERTISED_LINK_PROPOSALS;
+
+NeighborObserver::NeighborObserver(unsigned int max_time_slots_until_neighbor_not_active_anymore) : expiry_wheel(std::max(1u, std::min(max_time_slots_until_neighbor_not_active_anymore, MAX_NUM_EXPIRY_BUCKETS))), max_last_seen_val(max_time_slots_until_neighbor_not_active_anymore), first_neighbor_avg_last_seen(MovingAverage(this->num_time_slots_to_average)) {}
 
 void NeighborObserver::reportActivity(const MacId& id) {
 	uint64_t num_time_slots_since_last_seen = updateLastSeenCounter(id);
@@ -33,17 +37,22 @@ uint64_t NeighborObserver::updateLastSeenCounter(const MacId &id) {
 	if (it == active_neighbors.end()) {
 		// add it
 		num_time_slots_since_last_seen = 0;
-		active_neighbors.insert({id, num_time_slots_since_last_seen}); 		
+		active_neighbors.insert({id, current_slot}); 		
+		scheduleExpiry(id, current_slot + max_last_seen_val);
 	// if id already exists
 	} else {  
-		// get the current value
-		num_time_slots_since_last_seen = (*it).second;
-		// and reset to zero
-		(*it).second = 0;  // then set the counter value to zero slots	
+		// get the number of slots since it was last seen
+		num_time_slots_since_last_seen = current_slot - (*it).second;
+		// and update the last-seen slot, its wheel entry is moved on lazily when it is due
+		(*it).second = current_slot;
 	}
 	return num_time_slots_since_last_seen;
 }
 
+void NeighborObserver::scheduleExpiry(const MacId &id, uint64_t expiry_slot) {
+	expiry_wheel.at(expiry_slot % expiry_wheel.size()).push_back(id);
+}
+
 void NeighborObserver::updateAvgLastSeen(const MacId &id, uint64_t num_time_slots_since_last_seen) {	
 	try {
 		if (first_neighbor_id == SYMBOLIC_ID_UNSET) 		
@@ -59,54 +68,56 @@ void NeighborObserver::updateAvgLastSeen(const MacId &id, uint64_t num_time_slot
 		// add it		
 		auto pair = avg_last_seen.emplace(id, this->num_time_slots_to_average);		
 		// add the value only if this is not a new observation
-		if (num_time_slots_since_last_seen > 0 && pair.second)
+		if (num_time_slots_since_last_seen > 0 && pair.second) {
 			pair.first->second.put(num_time_slots_since_last_seen);
+			updateAvgBeaconDelayAggregate(0.0, pair.first->second.get());
+		}
 	// if id already exists
 	} else {
+		double previous_avg = (*it).second.get();
 		(*it).second.put(num_time_slots_since_last_seen);
+		updateAvgBeaconDelayAggregate(previous_avg, (*it).second.get());
 	}
 }
 
+void NeighborObserver::updateAvgBeaconDelayAggregate(double previous_avg, double new_avg) {
+	if (previous_avg > 0.0) {
+		sum_avg_last_seen -= previous_avg;
+		num_positive_avg_last_seen--;
+	}
+	if (new_avg > 0.0) {
+		sum_avg_last_seen += new_avg;
+		num_positive_avg_last_seen++;
+	}
+	// don't carry rounding errors over once no averages are left
+	if (num_positive_avg_last_seen == 0)
+		sum_avg_last_seen = 0.0;
+}
+
 void NeighborObserver::onSlotEnd() {
-	// go through all active neighbors
-	std::vector<std::map<MacId, unsigned int>::iterator> to_delete;
-	for (auto it = active_neighbors.begin(); it != active_neighbors.end(); ) {
-		// increment its last-seen value
-		it->second++;
-		// decrement its next advertised broadcast
-		const MacId &id = it->first;
-		auto broadcast_slot_it = advertised_broadcast_slots.find(id);
-		bool erased_broadcast_element = false;
-		if (broadcast_slot_it != advertised_broadcast_slots.end()) {									
-			// decrement
-			if (broadcast_slot_it->second > 0) 
-				(*broadcast_slot_it).second--;				
-			else { // or erase if it goes beyond zero
-				try {
-					advertised_broadcast_slots.erase(broadcast_slot_it);			
-					erased_broadcast_element = true;
-				} catch (const std::exception &e) {
-					throw std::runtime_error("NeighborObserver error during erase (1st): " + std::string(e.what()));
-				}								
-			}
-		}
-		// and remove it if it hasn't been reported for too long
-		if (it->second >= this->max_last_seen_val) {
-			try {				
-				it = active_neighbors.erase(it);				
-			} catch (const std::exception &e) {
-					throw std::runtime_error("NeighborObserver error during erase (2nd): " + std::string(e.what()));
-				}
-			if (!erased_broadcast_element && broadcast_slot_it != advertised_broadcast_slots.end()) {				
-				try {
-					advertised_broadcast_slots.erase(broadcast_slot_it);
-				} catch (const std::exception &e) {
-					throw std::runtime_error("NeighborObserver error during erase (3rd): " + std::string(e.what()));
-				}				
-			}
+	current_slot++;
+	// forget advertised broadcast slots that have passed
+	while (!advertised_broadcast_slots_by_slot.empty() && advertised_broadcast_slots_by_slot.begin()->first < current_slot) {
+		advertised_broadcast_slots.erase(advertised_broadcast_slots_by_slot.begin()->second);
+		advertised_broadcast_slots_by_slot.erase(advertised_broadcast_slots_by_slot.begin());
+	}
+	// only go through the neighbors in the bucket that is due now
+	std::vector<MacId> due_neighbors;
+	due_neighbors.swap(expiry_wheel.at(current_slot % expiry_wheel.size()));
+	for (const MacId &id : due_neighbors) {
+		auto it = active_neighbors.find(id);
+		if (it == active_neighbors.end())
+			continue;
+		uint64_t expiry_slot = it->second + max_last_seen_val;
+		// remove it if it hasn't been reported for too long
+		if (expiry_slot <= current_slot) {
+			active_neighbors.erase(it);
+			eraseBroadcastSlotAdvertisement(id);
+			advertised_link_proposals.erase(id);
+		// or move it on if it has been seen since or expires in a later turn of the wheel
 		} else
-			++it;
-	}	
+			scheduleExpiry(id, expiry_slot);
+	}
 }
 
 size_t NeighborObserver::getNumActiveNeighbors() const {
@@ -125,18 +136,25 @@ std::vector<MacId> NeighborObserver::getActiveNeighbors() const {
 }
 
 void NeighborObserver::reportBroadcastSlotAdvertisement(const MacId& id, unsigned int advertised_slot_offset) {
+	eraseBroadcastSlotAdvertisement(id);
+	// save the absolute slot, s.t. it needn't be decremented each slot
+	const uint64_t advertised_slot = current_slot + advertised_slot_offset;
+	advertised_broadcast_slots[id] = advertised_slot;
+	advertised_broadcast_slots_by_slot.insert({advertised_slot, id});
+}
+
+void NeighborObserver::eraseBroadcastSlotAdvertisement(const MacId &id) {
 	auto it = advertised_broadcast_slots.find(id);
-	// if id does not exist
 	if (it == advertised_broadcast_slots.end())
-		advertised_broadcast_slots.insert({id, advertised_slot_offset}); // add it
-	else  // if it does
-		(*it).second = advertised_slot_offset;  // then set the advertised value
+		return;
+	advertised_broadcast_slots_by_slot.erase({it->second, id});
+	advertised_broadcast_slots.erase(it);
 }
 
 unsigned int NeighborObserver::getNextExpectedBroadcastSlotOffset(const MacId &id) const {
 	auto it = advertised_broadcast_slots.find(id);	
 	if (it != advertised_broadcast_slots.end())
-		return (*it).second;
+		return (unsigned int) ((*it).second - current_slot);
 	else  
 		throw std::invalid_argument("no saved next broadcast slot for ID " + std::to_string(id.getId()));
 }
@@ -144,48 +162,47 @@ unsigned int NeighborObserver::getNextExpectedBroadcastSlotOffset(const MacId &i
 void NeighborObserver::clearAdvertisedLinkProposals(const MacId &id) {
 	auto it = advertised_link_proposals.find(id);
 	if (it != advertised_link_proposals.end())
-		it->second.clear();
+		it->second.proposals.clear();
 }
 
-void NeighborObserver::addAdvertisedLinkProposal(const MacId &id, unsigned long current_slot, const LinkProposal &proposal) {		
+void NeighborObserver::addAdvertisedLinkProposal(const MacId &id, unsigned long mac_slot, const LinkProposal &proposal) {		
 	auto it = advertised_link_proposals.find(id);
 	if (it == advertised_link_proposals.end()) {		
-		auto proposals = std::vector<std::pair<unsigned long, LinkProposal>>();
-		proposals.push_back({current_slot, LinkProposal(proposal)});
-		advertised_link_proposals.insert({id, proposals});
-	} else 
-		it->second.push_back({current_slot, LinkProposal(proposal)});	
+		it = advertised_link_proposals.emplace(id, AdvertisedLinkProposals()).first;
+		it->second.proposals.reserve(MAX_NUM_ADVERTISED_LINK_PROPOSALS);
+	}
+	AdvertisedLinkProposals &advertised = it->second;
+	pruneAdvertisedLinkProposals(advertised, mac_slot);
+	if (advertised.proposals.size() >= MAX_NUM_ADVERTISED_LINK_PROPOSALS)
+		advertised.proposals.erase(advertised.proposals.begin());
+	advertised.proposals.push_back(proposal);
 }
 
-std::vector<LinkProposal> NeighborObserver::getAdvertisedLinkProposals(const MacId &id, const unsigned long current_slot) const {
-	std::vector<LinkProposal> valid_proposals;
+void NeighborObserver::pruneAdvertisedLinkProposals(AdvertisedLinkProposals &advertised, unsigned long mac_slot) {
+	if (mac_slot <= advertised.normalized_at_slot)
+		return;
+	int num_elapsed_slots = (int) (mac_slot - advertised.normalized_at_slot);
+	for (auto &proposal : advertised.proposals)
+		proposal.slot_offset -= num_elapsed_slots;
+	advertised.proposals.erase(std::remove_if(advertised.proposals.begin(), advertised.proposals.end(), [](const LinkProposal &proposal) {return proposal.slot_offset <= 0;}), advertised.proposals.end());
+	advertised.normalized_at_slot = mac_slot;
+}
+
+const std::vector<LinkProposal>& NeighborObserver::getAdvertisedLinkProposals(const MacId &id, const unsigned long mac_slot) {
 	auto it = advertised_link_proposals.find(id);
-	if (it != advertised_link_proposals.end()) {
-		const std::vector<std::pair<unsigned long, LinkProposal>> &proposals = (*it).second;
-		for (const auto &item : proposals) {
-			const unsigned long &slot_when_saved = item.first;
-			unsigned long num_elapsed_slots = current_slot - slot_when_saved;
-			const LinkProposal &proposal = item.second;
-			LinkProposal normalized_proposal = LinkProposal(proposal);
-			normalized_proposal.slot_offset -= num_elapsed_slots;
-			if (normalized_proposal.slot_offset > 0)
-				valid_proposals.push_back(normalized_proposal);
-		}
+	if (it == advertised_link_proposals.end())
+		return no_advertised_link_proposals;
+	pruneAdvertisedLinkProposals(it->second, mac_slot);
+	// forget neighbors whose proposals have all expired
+	if (it->second.proposals.empty()) {
+		advertised_link_proposals.erase(it);
+		return no_advertised_link_proposals;
 	}
-	return valid_proposals;
+	return it->second.proposals;
 }
 
 double NeighborObserver::getAvgBeaconDelay() const {
-	double avg = 0.0;
-	size_t i = 0;
-	for (auto pair : avg_last_seen) {
-		double current_avg = pair.second.get();
-		if (current_avg > 0.0) {
-			avg += current_avg;
-			i++;
-		}
-	}
-	return avg / ((double) i);
+	return sum_avg_last_seen / ((double) num_positive_avg_last_seen);
 }
 
 double NeighborObserver::getAvgFirstNeighborBeaconDelay() const {
@@ -20,6 +20,7 @@
 
 #include <MacId.hpp>
 #include <map>
+#include <set>
 #include <vector>
 #include "LinkProposal.hpp"
 #include "MovingAverage.hpp"
@@ -27,6 +28,7 @@
 namespace TUHH_INTAIRNET_MCSOTDMA {
 	/**
 	 * Keeps track of recently observed, active neighbors.
+	 * Last-seen times are saved as absolute time slots, and neighbors are expired through a timing wheel, s.t. onSlotEnd() only touches neighbors that may be expiring.
 	 */
 	class NeighborObserver {
 
@@ -43,28 +45,66 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		bool isActive(const MacId& id) const;
 		std::vector<MacId> getActiveNeighbors() const;
 		void clearAdvertisedLinkProposals(const MacId &id);
-		void addAdvertisedLinkProposal(const MacId &id, unsigned long current_slot, const LinkProposal &proposal);
-		std::vector<LinkProposal> getAdvertisedLinkProposals(const MacId &id, const unsigned long current_slot) const;
-		/** @return The average over the average last-seen of all neighbors. */
+		/** Saves a proposal, whose slot offset is relative to the MAC's current time slot mac_slot. If MAX_NUM_ADVERTISED_LINK_PROPOSALS are already saved for this neighbor, the oldest is dropped. */
+		void addAdvertisedLinkProposal(const MacId &id, unsigned long mac_slot, const LinkProposal &proposal);
+		/**
+		 * Prunes expired proposals and normalizes the remaining ones in-place.
+		 * @return View onto the proposals advertised by this neighbor whose slot offsets, relative to the MAC's current time slot mac_slot, lie in the future. It is valid until the next call that concerns this neighbor's proposals.
+		 */
+		const std::vector<LinkProposal>& getAdvertisedLinkProposals(const MacId &id, const unsigned long mac_slot);
+		/** @return The average over the average last-seen of all neighbors, in O(1) from the maintained aggregate. */
 		double getAvgBeaconDelay() const;
 		/** @return The average time in-between beacon receptions of the first neighbor whose beacon has been received. */
 		double getAvgFirstNeighborBeaconDelay() const;
 
 	protected:		
-		/** Sets the respective value in active_neighbors, which is incremented each slot. 
+		/** Sets the respective value in active_neighbors to the current slot. 
 		 * @return The number of time slots since this user was last seen.
 		*/
 		uint64_t updateLastSeenCounter(const MacId &id);
+		/** Puts the neighbor into the timing wheel bucket of the time slot when it expires. */
+		void scheduleExpiry(const MacId &id, uint64_t expiry_slot);
 		/** Updates the respective average value of the number of time slots in-between beacon receptions. */
 		void updateAvgLastSeen(const MacId &id, uint64_t num_time_slots_since_last_seen);
+		/** Replaces a neighbor's previous average by its new one in the aggregate that getAvgBeaconDelay() reads. Only positive averages are counted. */
+		void updateAvgBeaconDelayAggregate(double previous_avg, double new_avg);
+		/** Erases the neighbor's advertised broadcast slot, if any. */
+		void eraseBroadcastSlotAdvertisement(const MacId &id);
+		
+		/** A neighbor's advertised link proposals, whose slot offsets are relative to the MAC's time slot normalized_at_slot. */
+		class AdvertisedLinkProposals {
+		public:
+			unsigned long normalized_at_slot = 0;
+			std::vector<LinkProposal> proposals;
+		};
+		/** Shifts the slot offsets to be relative to the MAC's time slot mac_slot and removes proposals that have started. */
+		void pruneAdvertisedLinkProposals(AdvertisedLinkProposals &advertised, unsigned long mac_slot);
  
 	protected:
-		/** Pairs of <ID, last-seen-this-many-slots-ago> */
-		std::map<MacId, unsigned int> active_neighbors;
-		/** Pairs of <ID, next-broadcast> */
-		std::map<MacId, unsigned int> advertised_broadcast_slots;
-		std::map<MacId, std::vector<std::pair<unsigned long, LinkProposal>>> advertised_link_proposals;
+		/** Number of onSlotEnd() calls so far, which serves as the clock for all absolute time slots. */
+		uint64_t current_slot = 0;
+		/** Pairs of <ID, absolute time slot when last seen> */
+		std::map<MacId, uint64_t> active_neighbors;
+		/** Pairs of <ID, absolute time slot of the next broadcast> */
+		std::map<MacId, uint64_t> advertised_broadcast_slots;
+		/** The same advertisements as <absolute time slot of the next broadcast, ID>, ordered s.t. those that have passed are erased from the front. */
+		std::set<std::pair<uint64_t, MacId>> advertised_broadcast_slots_by_slot;
+		/** 
+		 * Each active neighbor is held in exactly one bucket. When a bucket is due, neighbors that have been seen since are moved on to the bucket of their new expiry slot.
+		 * Expiries that lie further ahead than the number of buckets are simply revisited once per turn of the wheel.
+		 */
+		std::vector<std::vector<MacId>> expiry_wheel;
+		static const unsigned int MAX_NUM_EXPIRY_BUCKETS = 4096;
+		std::map<MacId, AdvertisedLinkProposals> advertised_link_proposals;
+		/** Maximum number of saved proposals per neighbor. */
+		static const size_t MAX_NUM_ADVERTISED_LINK_PROPOSALS = 16;
+		/** Returned for neighbors without any saved proposals. */
+		const std::vector<LinkProposal> no_advertised_link_proposals;
 		std::map<MacId, MovingAverage> avg_last_seen;
+		/** Sum over all positive averages in avg_last_seen. */
+		double sum_avg_last_seen = 0.0;
+		/** Number of positive averages in avg_last_seen. */
+		size_t num_positive_avg_last_seen = 0;
 		/** Number of time slots to use for the moving averages in avg_last_seen.*/
 		const uint64_t num_time_slots_to_average = 10;
 		/** Average time in-between beacons of the first user whose beacon has been received. */
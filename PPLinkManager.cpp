@@ -61,6 +61,7 @@ void PPLinkManager::notifyOutgoing(unsigned long num_bits) {
 
 void PPLinkManager::establishLink() {	
 	establishment_attempts++;
+	mac->traceLinkMilestone("PPLinkManager::establishLink", mac->getMacId(), link_id, TraceRingBuffer::pp_link_establishment_started, link_id.getId(), establishment_attempts);
 	coutd << "starting link establishment #" << establishment_attempts << " -> ";		
 	if (establishment_attempts >= max_establishment_attempts) {
 		coutd << "exceeded max. no of link establishment attempts, giving up -> ";
@@ -142,6 +143,7 @@ bool PPLinkManager::decrementTimeout() {
 				coutd << *mac << "::" << *this << " timeout " << timeout << "->";
 				timeout--;
 				coutd << timeout << " -> ";
+				mac->getPPDutyCycleBudget().set(link_id, getNumTxPerTimeSlot(), timeout);
 			}
 		} catch (const std::exception &e) {
 			std::stringstream ss;
@@ -153,6 +155,7 @@ bool PPLinkManager::decrementTimeout() {
 }
 
 void PPLinkManager::onTimeoutExpiry() { 
+	mac->traceLinkMilestone("PPLinkManager::onTimeoutExpiry", mac->getMacId(), link_id, TraceRingBuffer::pp_link_expired, link_id.getId());
 	coutd << "timeout reached, link expires -> ";
 	reserved_resources.reset();
 	cancelLink();
@@ -189,7 +192,7 @@ bool PPLinkManager::isActive() const {
 }
 
 void PPLinkManager::lockProposedResources(const LinkProposal& proposed_link) {	
-	auto slots = SlotCalculator::calculateAlternatingBursts(proposed_link.slot_offset, proposed_link.num_tx_initiator, proposed_link.num_tx_recipient, proposed_link.period, mac->getDefaultPPLinkTimeout());
+	const auto slots = SlotCalculator::viewAlternatingBursts(proposed_link.slot_offset, proposed_link.num_tx_initiator, proposed_link.num_tx_recipient, proposed_link.period, mac->getDefaultPPLinkTimeout());
 	const auto &tx_slots = slots.first;
 	const auto &rx_slots = slots.second;
 	ReservationTable *table = mac->getReservationManager()->getReservationTable(mac->getReservationManager()->getFreqChannelByCenterFreq(proposed_link.center_frequency));
@@ -283,6 +286,7 @@ int PPLinkManager::getRemainingTimeout() const {
 }
 
 void PPLinkManager::acceptLink(LinkProposal proposal, bool through_request, uint64_t generation_time) {
+	mac->traceLinkMilestone("PPLinkManager::acceptLink", mac->getMacId(), link_id, TraceRingBuffer::pp_link_accepted, link_id.getId(), proposal.slot_offset, proposal.period);
 	coutd << *this << " accepting link -> ";
 	coutd << "unlocking " << reserved_resources.size_locked() << " and unscheduling " << reserved_resources.size_scheduled() << " resources -> ";
 	cancelLink();
@@ -299,11 +303,8 @@ void PPLinkManager::acceptLink(LinkProposal proposal, bool through_request, uint
 	} catch (const std::exception &e) {
 		std::stringstream ss;
 		ss << *mac << "::" << *this << "::acceptLink has accepted faulty link: " << e.what();
-		std::pair<std::vector<double>, std::vector<int>> pp_budgets = mac->getUsedPPDutyCycleBudget();
-		size_t num_pp_links = pp_budgets.first.size();
-		ss << "#active PP links is " << num_pp_links << " and used duty cycle budgets are: ";
-		for (double d : pp_budgets.first)
-			ss << d << " ";
+		const PPDutyCycleBudget &pp_budget = mac->getPPDutyCycleBudget();
+		ss << "#active PP links is " << pp_budget.size() << " and used duty cycle budget is " << pp_budget.getTotal() << " ";
 		ss << "used SH budget is " << mac->getUsedSHDutyCycleBudget();
 		throw std::runtime_error(ss.str());
 	}
@@ -324,6 +325,7 @@ void PPLinkManager::acceptLink(LinkProposal proposal, bool through_request, uint
 	mac->statisticReportPPLinkEstablishmentTime(link_establishment_time);
 	// set timeout
 	this->timeout = mac->getDefaultPPLinkTimeout();	
+	mac->getPPDutyCycleBudget().set(link_id, getNumTxPerTimeSlot(), timeout);
 	((SHLinkManager*) mac->getLinkManager(SYMBOLIC_LINK_ID_BROADCAST))->cancelLinkRequest(link_id);
 	((SHLinkManager*) mac->getLinkManager(SYMBOLIC_LINK_ID_BROADCAST))->cancelLinkReply(link_id);
 	establishment_attempts = 0;
@@ -357,6 +359,7 @@ void PPLinkManager::cancelLink() {
 	size_t num_unlocked = reserved_resources.unlock_either_id(mac->getMacId(), link_id);		
 	size_t num_unscheduled = reserved_resources.unschedule({Reservation::TX, Reservation::RX});			
 	link_status = link_not_established;
+	mac->getPPDutyCycleBudget().remove(link_id);
 	reserved_resources.reset();
 	current_reservation_table = nullptr;	
 	auto *sh = (SHLinkManager*) mac->getLinkManager(SYMBOLIC_LINK_ID_BROADCAST);
@@ -28,6 +28,7 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 
 		friend class PPLinkManagerTests;
 		friend class ThirdPartyLinkTests;
+		friend class SystemTests;
 
 	public:
 		PPLinkManager(const MacId& link_id, ReservationManager *reservation_manager, MCSOTDMA_Mac *mac);
@@ -0,0 +1,136 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef TUHH_INTAIRNET_MC_SOTDMA_PENDINGMESSAGEQUEUE_HPP
+#define TUHH_INTAIRNET_MC_SOTDMA_PENDINGMESSAGEQUEUE_HPP
+
+#include <list>
+#include <deque>
+#include <unordered_map>
+#include <stdexcept>
+#include <MacId.hpp>
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+
+/**
+ * First-in-first-out queue of messages that are pending for transmission to some destination, e.g. link requests or replies.
+ * Entries are indexed by their destination, s.t. all those of one destination are found and removed without searching the queue.
+ */
+template <typename T>
+class PendingMessageQueue {
+public:
+	typedef std::list<std::pair<MacId, T>> Entries;
+	typedef typename Entries::const_iterator const_iterator;
+
+	PendingMessageQueue() = default;
+
+	/** The index refers into the queue it belongs to, so it is rebuilt rather than copied. */
+	PendingMessageQueue(const PendingMessageQueue &other) {
+		for (const auto &entry : other)
+			push_back(entry.first, entry.second);
+	}
+
+	PendingMessageQueue& operator=(const PendingMessageQueue &other) {
+		if (this != &other) {
+			clear();
+			for (const auto &entry : other)
+				push_back(entry.first, entry.second);
+		}
+		return *this;
+	}
+
+	/** Moving keeps the nodes that the index refers to. */
+	PendingMessageQueue(PendingMessageQueue &&other) = default;
+	PendingMessageQueue& operator=(PendingMessageQueue &&other) = default;
+
+	void push_back(const MacId &dest_id, const T &value) {
+		entries.emplace_back(dest_id, value);
+		index[dest_id.getId()].push_back(std::prev(entries.end()));
+	}
+
+	/**
+	 * Removes all entries for this destination.
+	 * @return The number of removed entries.
+	 */
+	size_t erase(const MacId &dest_id) {
+		auto it = index.find(dest_id.getId());
+		if (it == index.end())
+			return 0;
+		size_t num_erased = it->second.size();
+		for (const auto &entry_it : it->second)
+			entries.erase(entry_it);
+		index.erase(it);
+		return num_erased;
+	}
+
+	/**
+	 * @throws std::out_of_range If the queue is empty.
+	 */
+	const std::pair<MacId, T>& front() const {
+		if (entries.empty())
+			throw std::out_of_range("PendingMessageQueue::front for empty queue");
+		return entries.front();
+	}
+
+	/**
+	 * @throws std::out_of_range If the queue is empty.
+	 */
+	void pop_front() {
+		if (entries.empty())
+			throw std::out_of_range("PendingMessageQueue::pop_front for empty queue");
+		// entries of one destination are indexed in queue order, so the front entry is first in its index, too
+		auto it = index.find(entries.front().first.getId());
+		it->second.pop_front();
+		if (it->second.empty())
+			index.erase(it);
+		entries.pop_front();
+	}
+
+	bool contains(const MacId &dest_id) const {
+		return index.find(dest_id.getId()) != index.end();
+	}
+
+	size_t size() const {
+		return entries.size();
+	}
+
+	bool empty() const {
+		return entries.empty();
+	}
+
+	void clear() {
+		entries.clear();
+		index.clear();
+	}
+
+	const_iterator begin() const {
+		return entries.begin();
+	}
+
+	const_iterator end() const {
+		return entries.end();
+	}
+
+protected:
+	/** <destination, message> pairs in queue order. */
+	Entries entries;
+	/** Maps destination IDs to their entries, in queue order. */
+	std::unordered_map<int, std::deque<typename Entries::iterator>> index;
+};
+
+}
+
+#endif //TUHH_INTAIRNET_MC_SOTDMA_PENDINGMESSAGEQUEUE_HPP
@@ -0,0 +1,123 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <functional>
+#include <limits>
+#include "ProposalValidityCache.hpp"
+#include "SlotCalculator.hpp"
+
+using namespace TUHH_INTAIRNET_MCSOTDMA;
+
+bool ProposalValidityCache::Key::operator==(const Key &other) const {
+	return table == other.table && start_slot == other.start_slot && period == other.period && num_tx_initiator == other.num_tx_initiator && num_tx_recipient == other.num_tx_recipient && timeout == other.timeout && is_link_initiator == other.is_link_initiator;
+}
+
+size_t ProposalValidityCache::KeyHash::operator()(const Key &key) const {
+	size_t hash = std::hash<const ReservationTable*>()(key.table);
+	for (uint64_t value : {key.start_slot, (uint64_t) key.period, (uint64_t) key.num_tx_initiator, (uint64_t) key.num_tx_recipient, (uint64_t) key.timeout, (uint64_t) key.is_link_initiator})
+		hash ^= std::hash<uint64_t>()(value) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+	return hash;
+}
+
+bool ProposalValidityCache::makeKey(const ReservationTable *table, const LinkProposal &link, int timeout, bool is_link_initiator, Key &key) {
+	int64_t start_slot = (int64_t) table->getNumUpdatedSlots() + link.slot_offset;
+	if (start_slot < 0)
+		return false;
+	key.table = table;
+	key.start_slot = (uint64_t) start_slot;
+	key.period = link.period;
+	key.num_tx_initiator = link.num_tx_initiator;
+	key.num_tx_recipient = link.num_tx_recipient;
+	key.timeout = timeout;
+	key.is_link_initiator = is_link_initiator;
+	return true;
+}
+
+bool ProposalValidityCache::find(const ReservationTable *table, const LinkProposal &link, int timeout, bool is_link_initiator, bool &is_valid) const {
+	Key key;
+	if (!makeKey(table, link, timeout, is_link_initiator, key))
+		return false;
+	auto it = validities.find(key);
+	if (it == validities.end())
+		return false;
+	is_valid = it->second;
+	return true;
+}
+
+void ProposalValidityCache::insert(const ReservationTable *table, const ReservationTable *tx_table, const std::vector<ReservationTable*> &rx_tables, const LinkProposal &link, int timeout, bool is_link_initiator, bool is_valid) {
+	Key key;
+	if (!makeKey(table, link, timeout, is_link_initiator, key))
+		return;
+	// every time slot must be representable on every table, and the earliest one is the start slot
+	if (tx_table != nullptr && (int64_t) tx_table->getNumUpdatedSlots() + link.slot_offset < 0)
+		return;
+	for (const auto *rx_table : rx_tables)
+		if ((int64_t) rx_table->getNumUpdatedSlots() + link.slot_offset < 0)
+			return;
+	validities[key] = is_valid;
+	const auto tx_rx_slots = SlotCalculator::viewAlternatingBursts(link.slot_offset, link.num_tx_initiator, link.num_tx_recipient, link.period, timeout);
+	const auto &tx_slots = is_link_initiator ? tx_rx_slots.first : tx_rx_slots.second;
+	const auto &rx_slots = is_link_initiator ? tx_rx_slots.second : tx_rx_slots.first;
+	for (int slot : tx_slots) {
+		addDependency(table, slot, key);
+		if (tx_table != nullptr)
+			addDependency(tx_table, slot, key);
+	}
+	for (int slot : rx_slots) {
+		addDependency(table, slot, key);
+		for (const auto *rx_table : rx_tables)
+			addDependency(rx_table, slot, key);
+	}
+}
+
+void ProposalValidityCache::addDependency(const ReservationTable *table, int slot_offset, const Key &key) {
+	dependencies[{table, table->getNumUpdatedSlots() + slot_offset}].push_back(key);
+}
+
+void ProposalValidityCache::onChange(const ReservationTable *table, int slot_offset) {
+	int64_t slot = (int64_t) table->getNumUpdatedSlots() + slot_offset;
+	if (slot < 0)
+		return;
+	auto it = dependencies.find({table, (uint64_t) slot});
+	if (it == dependencies.end())
+		return;
+	for (const Key &key : it->second)
+		validities.erase(key);
+	dependencies.erase(it);
+}
+
+void ProposalValidityCache::onSlotStart() {
+	// tables may have been updated by different numbers of slots, so each one is pruned up to its own current slot
+	auto it = dependencies.begin();
+	while (it != dependencies.end()) {
+		const ReservationTable *table = it->first.first;
+		const auto first_it = it, current_slot_it = dependencies.lower_bound({table, table->getNumUpdatedSlots()});
+		for (; it != current_slot_it; it++)
+			for (const Key &key : it->second)
+				validities.erase(key);
+		dependencies.erase(first_it, current_slot_it);
+		it = dependencies.upper_bound({table, std::numeric_limits<uint64_t>::max()});
+	}
+}
+
+void ProposalValidityCache::clear() {
+	validities.clear();
+	dependencies.clear();
+}
+
+size_t ProposalValidityCache::size() const {
+	return validities.size();
+}
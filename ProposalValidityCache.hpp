@@ -0,0 +1,107 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef TUHH_INTAIRNET_MC_SOTDMA_PROPOSALVALIDITYCACHE_HPP
+#define TUHH_INTAIRNET_MC_SOTDMA_PROPOSALVALIDITYCACHE_HPP
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <LinkProposal.hpp>
+#include "ReservationTable.hpp"
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+
+	/**
+	 * Remembers whether link proposals are valid on a ReservationTable, together with the time slots that this depends on.
+	 * An entry stays until a reservation changes in one of these time slots, or until its first burst has passed, s.t. proposals that are checked over and over again are looked up instead of revalidated.
+	 * Time slots are identified through ReservationTable::getNumUpdatedSlots() + slot_offset, s.t. entries remain valid as time passes.
+	 */
+	class ProposalValidityCache {
+
+		friend class ReservationManagerTests;
+
+	public:
+		/**
+		 * @param table The channel's table.
+		 * @param link
+		 * @param timeout
+		 * @param is_link_initiator
+		 * @param is_valid Is set to the cached validity if there is one.
+		 * @return Whether there is a cached validity.
+		 */
+		bool find(const ReservationTable *table, const LinkProposal &link, int timeout, bool is_link_initiator, bool &is_valid) const;
+
+		/**
+		 * Caches the validity of a link, which depends on its TX and RX slots on 'table' and on the hardware tables.
+		 * @param table The channel's table.
+		 * @param tx_table Hardware transmitter table linked to 'table', may be nullptr.
+		 * @param rx_tables Hardware receiver tables linked to 'table'.
+		 * @param link
+		 * @param timeout
+		 * @param is_link_initiator
+		 * @param is_valid
+		 */
+		void insert(const ReservationTable *table, const ReservationTable *tx_table, const std::vector<ReservationTable*> &rx_tables, const LinkProposal &link, int timeout, bool is_link_initiator, bool is_valid);
+
+		/**
+		 * Drops all entries that depend on this time slot.
+		 * @param table
+		 * @param slot_offset
+		 */
+		void onChange(const ReservationTable *table, int slot_offset);
+
+		/** Drops all entries that depend on time slots that have passed. */
+		void onSlotStart();
+
+		void clear();
+
+		/** @return Number of cached validities. */
+		size_t size() const;
+
+	protected:
+		class Key {
+		public:
+			bool operator==(const Key &other) const;
+
+			const ReservationTable *table;
+			uint64_t start_slot;
+			int period, num_tx_initiator, num_tx_recipient, timeout;
+			bool is_link_initiator;
+		};
+
+		class KeyHash {
+		public:
+			size_t operator()(const Key &key) const;
+		};
+
+		/**
+		 * @param key Is set if the link starts at a representable time slot.
+		 * @return Whether 'key' was set.
+		 */
+		static bool makeKey(const ReservationTable *table, const LinkProposal &link, int timeout, bool is_link_initiator, Key &key);
+
+		/** Registers 'key' as depending on this time slot. */
+		void addDependency(const ReservationTable *table, int slot_offset, const Key &key);
+
+		/** Cached validities. */
+		std::unordered_map<Key, bool, KeyHash> validities;
+		/** Maps <table, time slot> to the keys whose validity depends on it. Keys whose entries have been dropped may remain until their time slots pass. */
+		std::map<std::pair<const ReservationTable*, uint64_t>, std::vector<Key>> dependencies;
+	};
+}
+
+#endif //TUHH_INTAIRNET_MC_SOTDMA_PROPOSALVALIDITYCACHE_HPP
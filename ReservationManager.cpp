@@ -29,6 +29,7 @@ void ReservationManager::addFrequencyChannel(bool is_p2p, uint64_t center_freque
 	auto* table = new ReservationTable(planning_horizon);
 	auto* channel = new FrequencyChannel(is_p2p, center_frequency, bandwidth);
 	table->linkFrequencyChannel(channel);
+	listenForChanges(table);
 	if (hardware_tx_table != nullptr)
 		table->linkTransmitterReservationTable(this->hardware_tx_table);
 	if (is_p2p) {
@@ -60,6 +61,7 @@ void ReservationManager::update(uint64_t num_slots) {
 		broadcast_reservation_table->update(num_slots);
 	for (ReservationTable* table : p2p_reservation_tables)
 		table->update(num_slots);
+	proposal_validity_cache.onSlotStart();
 }
 
 ReservationManager::~ReservationManager() {
@@ -182,6 +184,9 @@ FrequencyChannel* ReservationManager::matchFrequencyChannel(const FrequencyChann
 
 void ReservationManager::setTransmitterReservationTable(ReservationTable* tx_table) {
 	this->hardware_tx_table = tx_table;
+	listenForChanges(tx_table);
+	// cached validities didn't depend on this table
+	proposal_validity_cache.clear();
 }
 
 FrequencyChannel* ReservationManager::getFreqChannelByCenterFreq(uint64_t center_frequency) {
@@ -195,6 +200,8 @@ FrequencyChannel* ReservationManager::getFreqChannelByCenterFreq(uint64_t center
 
 void ReservationManager::addReceiverReservationTable(ReservationTable*& rx_table) {
 	this->hardware_rx_tables.push_back(rx_table);
+	listenForChanges(rx_table);
+	proposal_validity_cache.clear();
 }
 
 std::vector<FrequencyChannel*>& ReservationManager::getP2PFreqChannels() {
@@ -213,6 +220,45 @@ std::vector<ReservationTable*>& ReservationManager::getP2PReservationTables() {
 	return this->p2p_reservation_tables;
 }
 
+std::vector<bool> ReservationManager::areLinksValid(const std::vector<LinkProposal> &links, int timeout, bool is_link_initiator) {
+	// group by channel
+	std::map<uint64_t, std::vector<size_t>> indices_by_frequency;
+	for (size_t i = 0; i < links.size(); i++)
+		indices_by_frequency[links.at(i).center_frequency].push_back(i);
+	std::vector<bool> are_valid(links.size(), false);
+	std::vector<const LinkProposal*> channel_links;
+	std::vector<size_t> uncached_indices;
+	for (const auto &pair : indices_by_frequency) {
+		const ReservationTable *table = getReservationTable(getFreqChannelByCenterFreq(pair.first));
+		// only links that aren't cached are checked against the table
+		channel_links.clear();
+		uncached_indices.clear();
+		for (size_t i : pair.second) {
+			bool is_valid;
+			if (proposal_validity_cache.find(table, links.at(i), timeout, is_link_initiator, is_valid))
+				are_valid.at(i) = is_valid;
+			else {
+				channel_links.push_back(&links.at(i));
+				uncached_indices.push_back(i);
+			}
+		}
+		if (channel_links.empty())
+			continue;
+		const auto channel_results = table->areLinksValid(channel_links, timeout, is_link_initiator);
+		for (size_t j = 0; j < uncached_indices.size(); j++) {
+			are_valid.at(uncached_indices.at(j)) = channel_results.at(j);
+			proposal_validity_cache.insert(table, hardware_tx_table, hardware_rx_tables, *channel_links.at(j), timeout, is_link_initiator, channel_results.at(j));
+		}
+	}
+	return are_valid;
+}
+
+void ReservationManager::listenForChanges(ReservationTable *table) {
+	change_listeners.push_back(table->addChangeListener([this](const ReservationTable *changed_table, int slot_offset) {
+		proposal_validity_cache.onChange(changed_table, slot_offset);
+	}));
+}
+
 ReservationMap ReservationManager::scheduleBursts(const FrequencyChannel *channel, const int &start_slot_offset, const int &num_forward_bursts, const int &num_reverse_bursts, const int &period, const int &timeout, const MacId& initiator_id, const MacId& recipient_id, bool is_link_initiator) {	
 	ReservationMap reservation_map;
 	ReservationTable *tbl = getReservationTable(channel);	
@@ -222,11 +268,11 @@ ReservationMap ReservationManager::scheduleBursts(const FrequencyChannel *channe
 	action_2 = is_link_initiator ? Reservation::RX : Reservation::TX;	
 	MacId target_id = is_link_initiator ? recipient_id : initiator_id; 	
 	
-	auto tx_rx_slots = SlotCalculator::calculateAlternatingBursts(start_slot_offset, num_forward_bursts, num_reverse_bursts, period, timeout);	
+	const auto tx_rx_slots = SlotCalculator::viewAlternatingBursts(start_slot_offset, num_forward_bursts, num_reverse_bursts, period, timeout);	
 	size_t num_tx_scheduled = 0, num_rx_scheduled = 0;
 	// go over link initiator's TX slots	
 	coutd << (is_link_initiator ? "scheduling TX slots: " : "scheduling RX slots: ");
-	for (int &slot_offset : tx_rx_slots.first) {
+	for (int slot_offset : tx_rx_slots.first) {
 		bool can_write = false, can_overwrite = false;
 		const auto &res = tbl->getReservation(slot_offset);
 		// resource should be either idle 
@@ -272,7 +318,7 @@ ReservationMap ReservationManager::scheduleBursts(const FrequencyChannel *channe
 	}
 	coutd << (is_link_initiator ? "scheduling RX slots: " : "scheduling TX slots: ");
 	// go over the link initiator's RX slots
-	for (int &slot_offset : tx_rx_slots.second) {
+	for (int slot_offset : tx_rx_slots.second) {
 		bool can_write = false, can_overwrite = false;
 		const auto &res = tbl->getReservation(slot_offset);
 		// resource should be either idle 
@@ -324,4 +370,13 @@ ReservationMap ReservationManager::scheduleBursts(const FrequencyChannel *channe
 
 uint32_t ReservationManager::getPlanningHorizon() const {
 	return this->planning_horizon;
+}
+
+uint64_t ReservationManager::getGeneration() const {
+	uint64_t generation = hardware_tx_table != nullptr ? hardware_tx_table->getGeneration() : 0;
+	for (const auto *table : hardware_rx_tables)
+		generation += table->getGeneration();
+	for (const auto *table : p2p_reservation_tables)
+		generation += table->getGeneration();
+	return generation;
 }
\ No newline at end of file
@@ -23,6 +23,7 @@
 #include "ReservationTable.hpp"
 #include "FrequencyChannel.hpp"
 #include "ReservationMap.hpp"
+#include "ProposalValidityCache.hpp"
 #include <LinkProposal.hpp>
 
 namespace TUHH_INTAIRNET_MCSOTDMA {
@@ -77,6 +78,16 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 
 		ReservationTable* getReservationTable(const FrequencyChannel* channel);		
 
+		/**
+		 * Evaluates several links, e.g. those proposed in one header, by grouping them by channel and checking each group against its ReservationTable at once.
+		 * Results are cached until a reservation changes in any of the links' time slots, s.t. links that are checked repeatedly are only looked up.
+		 * @param links 
+		 * @param timeout 
+		 * @param is_link_initiator 
+		 * @return Whether each link is valid, in the order of 'links'.
+		 */
+		std::vector<bool> areLinksValid(const std::vector<LinkProposal> &links, int timeout, bool is_link_initiator);
+
 		FrequencyChannel* getBroadcastFreqChannel();
 
 		ReservationTable* getBroadcastReservationTable();
@@ -146,6 +157,11 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 
 		uint32_t getPlanningHorizon() const;
 
+		/**
+		 * @return Sum of ReservationTable::getGeneration() over the P2P and hardware tables. While it doesn't change, neither does any of their reservations.
+		 */
+		uint64_t getGeneration() const;
+
 	protected:
 
 		/**
@@ -155,6 +171,9 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 */
 		FrequencyChannel* matchFrequencyChannel(const FrequencyChannel& other) const;
 
+		/** Lets 'table' notify the proposal validity cache of its changes until this manager is destroyed. */
+		void listenForChanges(ReservationTable *table);
+
 		/** Number of slots to remember both in the past and in the future. */
 		uint32_t planning_horizon;
 		/** Keeps frequency channels in the same order as p2p_reservation_tables. */
@@ -173,6 +192,10 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		ReservationTable* hardware_tx_table = nullptr;
 		/** A number of hardware receiver ReservationTables may be kept, which will be linked to all ReservationTables within this manager. */
 		std::vector<ReservationTable*> hardware_rx_tables;
+		/** Validities of links checked through areLinksValid(). */
+		ProposalValidityCache proposal_validity_cache;
+		/** Tokens of the listeners registered through listenForChanges(). Hardware tables are owned by the PHY, and destroying these unregisters from them, whichever is destroyed first. */
+		std::vector<std::shared_ptr<ReservationTable::ChangeListener>> change_listeners;
 	};
 
 	inline std::ostream& operator<<(std::ostream& stream, const ReservationManager& manager) {
@@ -18,6 +18,7 @@
 #define TUHH_INTAIRNET_MC_SOTDMA_RESERVATIONMAP_HPP
 
 #include <vector>
+#include <deque>
 #include <sstream>
 #include <algorithm>
 #include <limits>
@@ -26,7 +27,11 @@
 
 namespace TUHH_INTAIRNET_MCSOTDMA {
 
-/** Container that saves the resources that were locked or scheduled during link establishment. */
+/** 
+ * Container that saves the resources that were locked or scheduled during link establishment. 
+ * Resources are kept sorted by time slot, and those that lie in the past are dropped as time passes, s.t. memory is bounded by the live reservations.
+ * Cursors onto the next transmission and reception advance with time, s.t. the next-slot queries are amortized O(1).
+ */
 class ReservationMap {
 
 	friend class PPLinkManagerTests;
@@ -37,21 +42,32 @@ public:
 
 	void merge(const ReservationMap& other) {
 		for (const auto& pair : other.scheduled_resources)
-			scheduled_resources.push_back(pair);	
+			add_scheduled_resource(pair.first, pair.second);
 		for (const auto& pair : other.locked_resources)
-			locked_resources.push_back(pair);	
+			add_locked_resource(pair.first, pair.second);
 	}
 
 	void add_scheduled_resource(ReservationTable *table, int slot_offset) {
-		scheduled_resources.push_back({table, slot_offset});
+		size_t index = insert_sorted(scheduled_resources, table, slot_offset);
+		// a cursor mustn't skip over the new resource
+		next_tx_index = std::min(next_tx_index, index);
+		next_rx_index = std::min(next_rx_index, index);
 	}
 
 	void add_locked_resource(ReservationTable *table, int slot_offset) {
-		locked_resources.push_back({table, slot_offset});
+		insert_sorted(locked_resources, table, slot_offset);
 	}
 
 	void onSlotStart() {
 		num_slots_since_creation++;
+		// drop resources that now lie in the past
+		while (!scheduled_resources.empty() && scheduled_resources.front().second < num_slots_since_creation) {
+			scheduled_resources.pop_front();
+			next_tx_index = next_tx_index > 0 ? next_tx_index - 1 : 0;
+			next_rx_index = next_rx_index > 0 ? next_rx_index - 1 : 0;
+		}
+		while (!locked_resources.empty() && locked_resources.front().second < num_slots_since_creation)
+			locked_resources.pop_front();
 	}
 
 	size_t size() const {
@@ -68,6 +84,8 @@ public:
 		this->scheduled_resources.clear();
 		this->locked_resources.clear();
 		this->num_slots_since_creation = 0;
+		this->next_tx_index = 0;
+		this->next_rx_index = 0;
 	}	
 
 	/** 	 
@@ -132,41 +150,83 @@ public:
 		return num_unscheduled;
 	}	
 
+	/**
+	 * @return All locked and scheduled resources that lie in the present or future, with slot offsets normalized to the current time slot.
+	 */
+	std::vector<std::pair<ReservationTable*, int>> getRemainingResources() const {
+		std::vector<std::pair<ReservationTable*, int>> remaining_resources;
+		for (const auto& pair : scheduled_resources) {
+			int slot_offset = pair.second - this->num_slots_since_creation;
+			if (slot_offset >= 0)
+				remaining_resources.push_back({pair.first, slot_offset});
+		}
+		for (const auto& pair : locked_resources) {
+			int slot_offset = pair.second - this->num_slots_since_creation;
+			if (slot_offset >= 0)
+				remaining_resources.push_back({pair.first, slot_offset});
+		}
+		return remaining_resources;
+	}
+
 	std::pair<ReservationTable*, int> getNextTxReservation() const {
-		int closest_time_slot = std::numeric_limits<int>::max();
-		std::pair<ReservationTable*, int> best_match = {nullptr, 0};
-		for (auto pair : scheduled_resources) {			
-			int time_slot = pair.second - this->num_slots_since_creation;
-			bool is_tx = pair.first->getReservation(pair.second - this->num_slots_since_creation).isTx();
-			if (time_slot >= 0 && time_slot < closest_time_slot && is_tx) {
-				closest_time_slot = time_slot;
-				best_match = pair;
-				best_match.second = time_slot;								
-			}
-		}		
-		return best_match;
+		return getNextReservation(next_tx_index, true);
 	}
 
 	std::pair<ReservationTable*, int> getNextRxReservation() const {
-		int closest_time_slot = std::numeric_limits<int>::max();
-		std::pair<ReservationTable*, int> best_match = {nullptr, 0};
-		for (auto pair : scheduled_resources) {			
-			int time_slot = pair.second - this->num_slots_since_creation;
-			bool is_rx = pair.first->getReservation(pair.second - this->num_slots_since_creation).isRx();
-			if (time_slot >= 0 && time_slot < closest_time_slot && is_rx) {
-				closest_time_slot = time_slot;
-				best_match = pair;
-				best_match.second = time_slot;
+		return getNextReservation(next_rx_index, false);
+	}
+
+	protected:
+		/**
+		 * Inserts behind all resources at the same time slot, s.t. these keep their insertion order.
+		 * @return The index of the inserted resource.
+		 */
+		static size_t insert_sorted(std::deque<std::pair<ReservationTable*, int>> &resources, ReservationTable *table, int slot_offset) {
+			// resources mostly come in chronological order
+			if (resources.empty() || resources.back().second <= slot_offset) {
+				resources.push_back({table, slot_offset});
+				return resources.size() - 1;
 			}
+			auto it = std::upper_bound(resources.begin(), resources.end(), slot_offset, [](int slot, const std::pair<ReservationTable*, int> &pair) {return slot < pair.second;});
+			size_t index = std::distance(resources.begin(), it);
+			resources.insert(it, {table, slot_offset});
+			return index;
+		}
+
+		/**
+		 * Advances the cursor past resources of the opposite kind, which stay that way until their time slots have passed.
+		 * Other non-matching resources, e.g. ones that have been unscheduled, are skipped without moving the cursor.
+		 * @param cursor Index into scheduled_resources.
+		 * @param tx Whether to look for a transmission or a reception.
+		 * @return The next matching resource with its slot offset normalized to the current time slot, or {nullptr, 0} if there is none.
+		 */
+		std::pair<ReservationTable*, int> getNextReservation(size_t &cursor, bool tx) const {
+			bool can_advance_cursor = true;
+			for (size_t i = cursor; i < scheduled_resources.size(); i++) {
+				const auto &pair = scheduled_resources[i];
+				int time_slot = pair.second - this->num_slots_since_creation;
+				bool is_opposite_kind = true;
+				// resources added after they've passed are only dropped at the next slot start
+				if (time_slot >= 0) {
+					const Reservation &res = pair.first->getReservation(time_slot);
+					if (tx ? res.isTx() : res.isRx())
+						return {pair.first, time_slot};
+					is_opposite_kind = tx ? res.isRx() : res.isTx();
+				}
+				can_advance_cursor = can_advance_cursor && is_opposite_kind;
+				if (can_advance_cursor)
+					cursor = i + 1;
+			}
+			return {nullptr, 0};
 		}
-		return best_match;
-	}
 
-	protected:		
-		std::vector<std::pair<ReservationTable*, int>> scheduled_resources;				
-		std::vector<std::pair<ReservationTable*, int>> locked_resources;		
+		/** <table, slot offset at creation> pairs sorted by time slot. */
+		std::deque<std::pair<ReservationTable*, int>> scheduled_resources;				
+		std::deque<std::pair<ReservationTable*, int>> locked_resources;		
 		/** Keep track of the number of time slots since creation, so that the slot offsets can be normalized to the current time. */
 		int num_slots_since_creation;
+		/** Cursors into scheduled_resources, before which there is no next transmission or reception, respectively. */
+		mutable size_t next_tx_index = 0, next_rx_index = 0;
 };
 
 }
@@ -19,6 +19,7 @@
 #include <math.h>
 #include <limits>
 #include <sstream>
+#include <bitset>
 #include "ReservationTable.hpp"
 #include "coutdebug.hpp"
 #include "MCSOTDMA_Mac.hpp"
@@ -34,6 +35,7 @@ ReservationTable::ReservationTable(uint32_t planning_horizon)
 	if (planning_horizon == UINT32_MAX)
 		throw std::invalid_argument("Cannot instantiate a reservation table with a planning horizon of UINT32_MAX. It must be at least one slot less.");
 	// In practice, allocating even much less results in a std::bad_alloc anyway...
+	tx_bits.resize((slot_utilization_vec.size() + 63) / 64, 0);
 }
 
 ReservationTable::ReservationTable() : ReservationTable(512) {}
@@ -42,6 +44,8 @@ ReservationTable::ReservationTable(uint32_t planning_horizon, const Reservation&
 	this->default_reservation = default_reservation;
 	for (auto& it : slot_utilization_vec)
 		it = default_reservation;
+	for (uint64_t i = 0; i < slot_utilization_vec.size(); i++)
+		setTxBit(i, default_reservation.isAnyTx());
 }
 
 uint32_t ReservationTable::getPlanningHorizon() const {
@@ -81,6 +85,8 @@ Reservation* ReservationTable::mark(int32_t slot_offset, const Reservation& rese
 	else
 		can_free_receiver = false;
 	this->slot_utilization_vec.at(convertOffsetToIndex(slot_offset)) = reservation;
+	setTxBit(convertOffsetToIndex(slot_offset), reservation.isAnyTx());
+	onChange(slot_offset);
 	// Update the number of idle slots.
 	if (currently_idle && !reservation.isIdle()) // idle -> non-idle
 		num_idle_future_slots--;
@@ -219,12 +225,13 @@ bool ReservationTable::isRxValid(int slot) const {
 }
 
 unsigned int ReservationTable::findEarliestIdleSlotsPP(int start_offset, int num_forward_bursts, int num_reverse_bursts, int period, int timeout) const {	
+	// the burst pattern is the same for each candidate start slot
+	const auto &pattern = SlotCalculator::getAlternatingBurstPattern(num_forward_bursts, num_reverse_bursts, period, timeout);
 	// start looking
 	for (int t = (int) start_offset; t < planning_horizon; t++) {
-		// save all starting slots of each burst
-		const auto tx_rx_slots = SlotCalculator::calculateAlternatingBursts(t, num_forward_bursts, num_reverse_bursts, period, timeout);		
-		const auto &tx_slots = tx_rx_slots.first;
-		const auto &rx_slots = tx_rx_slots.second;
+		// view all starting slots of each burst
+		const auto tx_slots = SlotCalculator::BurstSlots(pattern.tx_offsets, t);
+		const auto rx_slots = SlotCalculator::BurstSlots(pattern.rx_offsets, t);
 		if (tx_slots.empty())
 			throw std::invalid_argument("ReservationTable::findEarliestIdleSlotsPP for no TX slots");
 		if (rx_slots.empty())
@@ -297,7 +304,12 @@ void ReservationTable::update(uint64_t num_slots) {
 	// All new elements are initialized as idle.
 	for (auto it = slot_utilization_vec.end() - 1; it >= slot_utilization_vec.end() - num_slots; it--)
 		*it = default_reservation;
+	// Rotate the TX bitmap instead of shifting it, and overwrite the bits of the new elements.
+	tx_bits_start = (tx_bits_start + num_slots) % (tx_bits.size() * 64);
+	for (uint64_t i = slot_utilization_vec.size() - std::min((uint64_t) slot_utilization_vec.size(), num_slots); i < slot_utilization_vec.size(); i++)
+		setTxBit(i, default_reservation.isAnyTx());
 	last_updated += num_slots;
+	num_updated_slots += num_slots;
 }
 
 const std::vector<Reservation>& ReservationTable::getVec() const {
@@ -318,8 +330,40 @@ uint64_t ReservationTable::getNumIdleSlots() const {
 	return this->num_idle_future_slots;
 }
 
+uint64_t ReservationTable::getGeneration() const {
+	return generation;
+}
+
+uint64_t ReservationTable::getNumUpdatedSlots() const {
+	return num_updated_slots;
+}
+
+std::shared_ptr<ReservationTable::ChangeListener> ReservationTable::addChangeListener(const ChangeListener& listener) {
+	auto token = std::make_shared<ChangeListener>(listener);
+	change_listeners.push_back(token);
+	return token;
+}
+
+void ReservationTable::onChange(int slot_offset) {
+	generation++;
+	// listeners may register others, so iterate by index
+	for (size_t i = 0; i < change_listeners.size();) {
+		if (auto listener = change_listeners.at(i).lock()) {
+			(*listener)(this, slot_offset);
+			i++;
+		} else
+			change_listeners.erase(change_listeners.begin() + i);
+	}
+}
+
 std::vector<unsigned int> ReservationTable::findSHCandidates(unsigned int num_candidates, int min_offset) const {
 	std::vector<unsigned int> start_slots;
+	findSHCandidates(num_candidates, min_offset, start_slots);
+	return start_slots;
+}
+
+void ReservationTable::findSHCandidates(unsigned int num_candidates, int min_offset, std::vector<unsigned int> &start_slots) const {
+	start_slots.clear();
 	int last_offset = min_offset;
 	for (size_t i = 0; i < num_candidates; i++) {
 		try {
@@ -336,7 +380,6 @@ std::vector<unsigned int> ReservationTable::findSHCandidates(unsigned int num_ca
 			break; // Stop if no more ranges can be found.
 		} // all other exceptions should still end execution
 	}
-	return start_slots;
 }
 
 std::vector<unsigned int> ReservationTable::findPPCandidates(unsigned int num_proposal_slots, unsigned int min_offset, int num_forward_bursts, int num_reverse_bursts, int period, int timeout) const {
@@ -363,6 +406,51 @@ std::vector<unsigned int> ReservationTable::findPPCandidates(unsigned int num_pr
 	return start_slot_offsets;
 }
 
+std::vector<std::vector<unsigned int>> ReservationTable::findPPCandidates(unsigned int num_proposal_slots, unsigned int min_offset, int num_forward_bursts, int num_reverse_bursts, int min_period, int max_period, int timeout) const {
+	std::vector<std::vector<unsigned int>> start_slot_offsets;
+	// availability shared by all periods
+	AvailabilityCache availability(this);
+	auto is_tx_valid = [&availability](int slot) {return availability.isTxValid(slot);};
+	auto is_rx_valid = [&availability](int slot) {return availability.isRxValid(slot);};
+	for (int period = min_period; period <= max_period; period++) {
+		start_slot_offsets.emplace_back();
+		auto &period_start_slot_offsets = start_slot_offsets.back();
+		const auto &pattern = SlotCalculator::getAlternatingBurstPattern(num_forward_bursts, num_reverse_bursts, period, timeout);
+		if (pattern.tx_offsets.empty() || pattern.rx_offsets.empty())
+			continue;
+		try {
+			for (int t = (int) min_offset; t < (int) planning_horizon && period_start_slot_offsets.size() < num_proposal_slots; t++) {
+				const auto tx_slots = SlotCalculator::BurstSlots(pattern.tx_offsets, t);
+				const auto rx_slots = SlotCalculator::BurstSlots(pattern.rx_offsets, t);
+				if (std::all_of(tx_slots.begin(), tx_slots.end(), is_tx_valid) && std::all_of(rx_slots.begin(), rx_slots.end(), is_rx_valid))
+					period_start_slot_offsets.push_back(t);
+			}
+		} catch (const std::invalid_argument& e) {
+			// This is thrown if we are exceeding the planning horizon, as for findPPCandidates().
+		}
+	}
+	return start_slot_offsets;
+}
+
+ReservationTable::AvailabilityCache::AvailabilityCache(const ReservationTable *table) : table(table), tx_mask(table->planning_horizon + 1, 0), rx_mask(table->planning_horizon + 1, 0) {}
+
+bool ReservationTable::AvailabilityCache::isTxValid(int slot) {
+	// slots beyond the planning horizon are passed on, s.t. they are reported as usual
+	if (slot < 0 || slot > (int) table->planning_horizon)
+		return table->isTxValid(slot);
+	if (tx_mask[slot] == 0)
+		tx_mask[slot] = table->isTxValid(slot) ? 1 : 2;
+	return tx_mask[slot] == 1;
+}
+
+bool ReservationTable::AvailabilityCache::isRxValid(int slot) {
+	if (slot < 0 || slot > (int) table->planning_horizon)
+		return table->isRxValid(slot);
+	if (rx_mask[slot] == 0)
+		rx_mask[slot] = table->isRxValid(slot) ? 1 : 2;
+	return rx_mask[slot] == 1;
+}
+
 bool ReservationTable::lock(unsigned int slot_offset, const MacId& id) {
 	// Nothing to do if it's already locked.
 	MacId res_id = slot_utilization_vec.at(convertOffsetToIndex(slot_offset)).getTarget();
@@ -382,6 +470,7 @@ bool ReservationTable::lock(unsigned int slot_offset, const MacId& id) {
 	// Then lock.
 	slot_utilization_vec.at(convertOffsetToIndex(slot_offset)).setAction(Reservation::LOCKED);
 	slot_utilization_vec.at(convertOffsetToIndex(slot_offset)).setTarget(id);		
+	onChange(slot_offset);
 	return true;
 }
 
@@ -406,6 +495,7 @@ void ReservationTable::unlock(unsigned int slot_offset, const MacId& id) {
 		throw id_mismatch("cannot unlock locked reservation whose ID is " + std::to_string(slot_utilization_vec.at(convertOffsetToIndex(slot_offset)).getTarget().getId()) + " and not " + std::to_string(id.getId()));	
 	slot_utilization_vec.at(convertOffsetToIndex(slot_offset)).setAction(Reservation::IDLE);
 	slot_utilization_vec.at(convertOffsetToIndex(slot_offset)).setTarget(SYMBOLIC_ID_UNSET);		
+	onChange(slot_offset);
 }
 
 void ReservationTable::unlock_either_id(unsigned int slot_offset, const MacId& id1, const MacId& id2) {
@@ -458,8 +548,10 @@ ReservationTable* ReservationTable::getTxReservations(const MacId& id) const {
 	auto* table = new ReservationTable(this->planning_horizon);
 	for (size_t i = 0; i < slot_utilization_vec.size(); i++) {
 		const Reservation& reservation = slot_utilization_vec.at(i);
-		if (reservation.getTarget() == id && reservation.isAnyTx())
+		if (reservation.getTarget() == id && reservation.isAnyTx()) {
 			table->slot_utilization_vec.at(i) = Reservation(reservation);
+			table->setTxBit(i, true);
+		}
 	}
 	return table;
 }
@@ -469,8 +561,11 @@ void ReservationTable::integrateTxReservations(const ReservationTable* other) {
 		throw std::invalid_argument("ReservationTable::integrateTxReservations where other table doesn't have the same dimension!");
 	for (size_t i = 0; i < slot_utilization_vec.size(); i++) {
 		const Reservation& reservation = other->slot_utilization_vec.at(i);
-		if (reservation.isAnyTx())
+		if (reservation.isAnyTx()) {
 			slot_utilization_vec.at(i) = Reservation(reservation);
+			setTxBit(i, true);
+			onChange(((int) i) - ((int) planning_horizon));
+		}
 	}
 }
 
@@ -498,8 +593,58 @@ void ReservationTable::linkReceiverReservationTable(ReservationTable* rx_table)
 ReservationTable::~ReservationTable() = default;
 
 bool ReservationTable::isLinkValid(int start_slot_offset, int period, int num_tx_initiator, int num_tx_recipient, int timeout, bool is_link_initiator) const {
-	auto tx_rx_slots = SlotCalculator::calculateAlternatingBursts(start_slot_offset, num_tx_initiator, num_tx_recipient, period, timeout);
+	const auto tx_rx_slots = SlotCalculator::viewAlternatingBursts(start_slot_offset, num_tx_initiator, num_tx_recipient, period, timeout);
 	const auto &tx_slots = is_link_initiator ? tx_rx_slots.first : tx_rx_slots.second;
 	const auto &rx_slots = is_link_initiator ? tx_rx_slots.second : tx_rx_slots.first;	
 	return std::all_of(tx_slots.begin(), tx_slots.end(), [this](int slot){return this->isTxValid(slot);}) && std::all_of(rx_slots.begin(), rx_slots.end(), [this](int slot){return this->isRxValid(slot);});
-}
\ No newline at end of file
+}
+std::vector<bool> ReservationTable::areLinksValid(const std::vector<const LinkProposal*> &links, int timeout, bool is_link_initiator) const {
+	// availability shared by all links
+	AvailabilityCache availability(this);
+	auto is_tx_valid = [&availability](int slot) {return availability.isTxValid(slot);};
+	auto is_rx_valid = [&availability](int slot) {return availability.isRxValid(slot);};
+	std::vector<bool> are_valid(links.size(), false);
+	for (size_t i = 0; i < links.size(); i++) {
+		const LinkProposal &link = *links.at(i);
+		const auto tx_rx_slots = SlotCalculator::viewAlternatingBursts(link.slot_offset, link.num_tx_initiator, link.num_tx_recipient, link.period, timeout);
+		const auto &tx_slots = is_link_initiator ? tx_rx_slots.first : tx_rx_slots.second;
+		const auto &rx_slots = is_link_initiator ? tx_rx_slots.second : tx_rx_slots.first;
+		are_valid.at(i) = std::all_of(tx_slots.begin(), tx_slots.end(), is_tx_valid) && std::all_of(rx_slots.begin(), rx_slots.end(), is_rx_valid);
+	}
+	return are_valid;
+}
+
+unsigned int ReservationTable::countTxReservations(int32_t start, uint32_t length) const {
+	if (length == 0)
+		return 0;
+	if (!isValid(start, length))
+		throw std::invalid_argument("ReservationTable::countTxReservations for range [" + std::to_string(start) + ", " + std::to_string(start + (int64_t) length) + ") exceeding planning_horizon=" + std::to_string(planning_horizon));
+	const uint64_t num_bits = tx_bits.size() * 64;
+	uint64_t bit_position = (tx_bits_start + convertOffsetToIndex(start)) % num_bits;
+	// the range may wrap around the end of the bitmap
+	uint64_t first_length = std::min((uint64_t) length, num_bits - bit_position);
+	return countTxBits(bit_position, first_length) + countTxBits(0, length - first_length);
+}
+
+void ReservationTable::setTxBit(uint64_t index, bool is_tx) {
+	uint64_t bit_position = (tx_bits_start + index) % (tx_bits.size() * 64);
+	uint64_t mask = uint64_t(1) << (bit_position % 64);
+	if (is_tx)
+		tx_bits.at(bit_position / 64) |= mask;
+	else
+		tx_bits.at(bit_position / 64) &= ~mask;
+}
+
+unsigned int ReservationTable::countTxBits(uint64_t bit_position, uint64_t length) const {
+	unsigned int num_set_bits = 0;
+	while (length > 0) {
+		uint64_t word = tx_bits.at(bit_position / 64) >> (bit_position % 64);
+		uint64_t num_bits_in_word = std::min(length, 64 - bit_position % 64);
+		if (num_bits_in_word < 64)
+			word &= (uint64_t(1) << num_bits_in_word) - 1;
+		num_set_bits += std::bitset<64>(word).count();
+		bit_position += num_bits_in_word;
+		length -= num_bits_in_word;
+	}
+	return num_set_bits;
+}
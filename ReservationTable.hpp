@@ -19,7 +19,10 @@
 
 #include <vector>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <Timestamp.hpp>
+#include <LinkProposal.hpp>
 #include "Reservation.hpp"
 #include "FrequencyChannel.hpp"
 
@@ -97,6 +100,26 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 */
 		uint64_t getNumIdleSlots() const;
 
+		/**
+		 * @return Counter that is incremented whenever a reservation changes, but not as time passes. While it doesn't change, idle slots remain idle.
+		 */
+		uint64_t getGeneration() const;
+
+		/**
+		 * @return Number of time slots this table has been updated by, s.t. getNumUpdatedSlots() + slot_offset identifies a time slot independent of the current one.
+		 */
+		uint64_t getNumUpdatedSlots() const;
+
+		/** Called with the table and the slot offset whenever a reservation changes through mark(), lock(), unlock() or integrateTxReservations(). */
+		typedef std::function<void(const ReservationTable*, int)> ChangeListener;
+
+		/**
+		 * Registers a change listener alongside any others.
+		 * @param listener
+		 * @return Token that keeps the listener registered for as long as it exists. It may outlive this table, and this table may outlive it.
+		 */
+		std::shared_ptr<ChangeListener> addChangeListener(const ChangeListener& listener);
+
 		/**
 		 * @return The last time this table was updated.
 		 */
@@ -110,6 +133,14 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 
 		std::vector<unsigned int> findSHCandidates(unsigned int num_candidates, int min_offset) const;
 
+		/**
+		 * Finds the same candidates as findSHCandidates(), but writes them into a buffer that the caller can reuse.
+		 * @param num_candidates 
+		 * @param min_offset 
+		 * @param start_slots Cleared and then filled with the candidate slot offsets.
+		 */
+		void findSHCandidates(unsigned int num_candidates, int min_offset, std::vector<unsigned int> &start_slots) const;
+
 		/**		 
 		 * @param num_proposal_slots 
 		 * @param min_offset 
@@ -121,6 +152,19 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 */
 		std::vector<unsigned int> findPPCandidates(unsigned int num_proposal_slots, unsigned int min_offset, int num_forward_bursts, int num_reverse_bursts, int period, int timeout) const;		
 
+		/**
+		 * Evaluates findPPCandidates() for a range of periods in one pass, s.t. the availability of each time slot is checked at most once.
+		 * @param num_proposal_slots Maximum number of start slot offsets per period.
+		 * @param min_offset 
+		 * @param num_forward_bursts 
+		 * @param num_reverse_bursts 
+		 * @param min_period 
+		 * @param max_period 
+		 * @param timeout 
+		 * @return Start slot offsets that could be used to initiate a PP link, for each period from min_period to max_period.
+		 */
+		std::vector<std::vector<unsigned int>> findPPCandidates(unsigned int num_proposal_slots, unsigned int min_offset, int num_forward_bursts, int num_reverse_bursts, int min_period, int max_period, int timeout) const;
+
 		/**		 
 		 * @param slot_offset 
 		 * @param id 
@@ -214,6 +258,14 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 */
 		unsigned long countReservedTxSlots(const MacId& id) const;
 
+		/**
+		 * @param start Slot offset that marks the beginning of the range of slots.
+		 * @param length Number of slots in the range.
+		 * @return The number of slots in the range that hold any TX reservation, counted through popcounts over a bitmap.
+		 * @throws std::invalid_argument If the range exceeds the planning horizon.
+		 */
+		unsigned int countTxReservations(int32_t start, uint32_t length) const;
+
 		/**
 		 * @param id
 		 * @return A new ReservationTable that contains all TX and TX_CONT reservations targeted at 'id'.
@@ -259,6 +311,15 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 
 		bool isLinkValid(int start_slot_offset, int period, int num_tx_initiator, int num_tx_recipient, int timeout, bool is_link_initiator) const;
 
+		/**
+		 * Evaluates isLinkValid() for several links on this table together, s.t. the availability of each time slot is checked at most once.
+		 * @param links Links on this table's channel.
+		 * @param timeout 
+		 * @param is_link_initiator 
+		 * @return Whether each link is valid, in the order of 'links'.
+		 */
+		std::vector<bool> areLinksValid(const std::vector<const LinkProposal*> &links, int timeout, bool is_link_initiator) const;
+
 	protected:
 		bool isValid(int32_t slot_offset) const;
 
@@ -284,6 +345,15 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 */
 		uint64_t convertOffsetToIndex(int32_t slot_offset) const;		
 
+		/**
+		 * Keeps the TX bitmap in sync with slot_utilization_vec.
+		 * @param index Index into slot_utilization_vec.
+		 * @param is_tx
+		 */
+		void setTxBit(uint64_t index, bool is_tx);
+		/** @return Number of set bits within [bit_position, bit_position + length) of the TX bitmap, which must not wrap around. */
+		unsigned int countTxBits(uint64_t bit_position, uint64_t length) const;
+
 		/**		 
 		 * @param start_offset 
 		 * @param burst_length 
@@ -305,6 +375,20 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		bool isBurstValid(int start_slot, unsigned int burst_length, unsigned int burst_length_tx, bool rx_idle_during_first_slot, MCSOTDMA_Mac *mac) const;
 		bool isTxValid(int slot) const;
 		bool isRxValid(int slot) const;
+		/** Increments the generation and notifies the change listeners. */
+		void onChange(int slot_offset);
+
+		/** Remembers isTxValid() and isRxValid() for time slots within the planning horizon, s.t. many links can be checked against the same table state. */
+		class AvailabilityCache {
+		public:
+			explicit AvailabilityCache(const ReservationTable *table);
+			bool isTxValid(int slot);
+			bool isRxValid(int slot);
+		protected:
+			const ReservationTable *table;
+			/** 0 is unknown, 1 valid, 2 invalid */
+			std::vector<uint8_t> tx_mask, rx_mask;
+		};
 
 	protected:
 		/** Holds the utilization status of every slot from the current one up to some planning horizon both into past and future. */
@@ -315,6 +399,11 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		Timestamp last_updated;
 		/** The ReservationTable keeps track of the idle slots it currently has, so that different tables are easily compared for their capacity of new reservations. */
 		uint64_t num_idle_future_slots;
+		uint64_t generation = 0;
+		/** Sum of all num_slots passed to update(). */
+		uint64_t num_updated_slots = 0;
+		/** Notified of every change, see addChangeListener(). Expired ones are dropped on the next change. */
+		std::vector<std::weak_ptr<ChangeListener>> change_listeners;
 		FrequencyChannel* freq_channel = nullptr;
 
 		/** The ReservationTable of the single transmitter may be linked, so that all TX reservations are forwarded to it. */
@@ -323,6 +412,10 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		/** The ReservationTables of any receiver may be linked, so that all RX reservations can be forwarded to them. */
 		std::vector<ReservationTable*> receiver_reservation_tables;
 		Reservation default_reservation;
+		/** One bit per slot in slot_utilization_vec that is set if it holds a TX reservation. It is a ring buffer, s.t. update() needn't shift it. */
+		std::vector<uint64_t> tx_bits;
+		/** Bit position of slot_utilization_vec's first element. */
+		uint64_t tx_bits_start = 0;
 	};
 }
 
@@ -19,6 +19,7 @@
 #include "MCSOTDMA_Mac.hpp"
 #include "PPLinkManager.hpp"
 #include "LinkProposalFinder.hpp"
+#include "SlotCalculator.hpp"
 
 using namespace TUHH_INTAIRNET_MCSOTDMA;
 
@@ -42,12 +43,14 @@ L2Packet* SHLinkManager::onTransmissionReservation() {
 	// write source iD
 	header->src_id = mac->getMacId();	
 
-	// add link requests
-	if (!link_requests.empty())
-		coutd << "considering " << link_requests.size() << " pending link requests: ";
-	for (auto pair : link_requests) {		
-		MacId &dest_id = pair.first;	
-		uint64_t &generation_time = pair.second;	
+	// add link requests, which are taken from the queue s.t. cancelling them while they're processed is safe
+	PendingMessageQueue<uint64_t> pending_link_requests = std::move(link_requests);
+	link_requests.clear();
+	if (!pending_link_requests.empty())
+		coutd << "considering " << pending_link_requests.size() << " pending link requests: ";
+	for (const auto &pair : pending_link_requests) {		
+		const MacId &dest_id = pair.first;	
+		const uint64_t &generation_time = pair.second;	
 		coutd << "id=" << dest_id << " -> ";
 		// check if we know preferred links
 		const auto &advertised_normalized_proposals = mac->getNeighborObserver().getAdvertisedLinkProposals(dest_id, mac->getCurrentSlot());
@@ -111,6 +114,8 @@ L2Packet* SHLinkManager::onTransmissionReservation() {
 			mac->statisticReportLinkRequestSent();		
 		} else {
 			coutd << "empty proposals, couldn't propose links during link request -> ";
+			// try again during the next transmission
+			link_requests.push_back(dest_id, generation_time);
 		}
 	}
 	// remove link requests that have been added
@@ -139,10 +144,10 @@ L2Packet* SHLinkManager::onTransmissionReservation() {
 
 	// attach next link reply
 	if (!link_replies.empty()) {
-		auto reply = link_replies.at(0);
+		const auto &reply = link_replies.front().second;
 		coutd << "attaching link reply for " << reply.dest_id << " -> ";
 		header->link_reply = L2HeaderSH::LinkReply(reply);		
-		link_replies.erase(link_replies.begin());
+		link_replies.pop_front();
 		if (link_replies.empty())
 			coutd << "no more replies pending -> ";
 		else 
@@ -181,38 +186,21 @@ L2Packet* SHLinkManager::onTransmissionReservation() {
 }
 
 size_t SHLinkManager::cancelLinkRequest(const MacId& id) {
-	size_t num_cancelled = 0;
-	for (auto it = link_requests.begin(); it != link_requests.end();) {
-		if ((*it).first == id) {
-			it = link_requests.erase(it);
-			num_cancelled++;
-		} else
-			it++;
-	}
-	return num_cancelled;
+	precomputed_link_proposals.erase(id);
+	return link_requests.erase(id);
 }
 size_t SHLinkManager::cancelLinkReply(const MacId& id) {	
-	size_t num_cancelled = 0;
-	for (auto it = link_replies.begin(); it != link_replies.end();) {		
-		if ((*it).dest_id == id) {
-			it = link_replies.erase(it);
-			num_cancelled++;
-		} else
-			it++;
-	}
-	return num_cancelled;
+	return link_replies.erase(id);
 }
 
 std::pair<std::vector<LinkProposal>, int> SHLinkManager::proposeLocalLinks(const MacId& dest_id, int num_forward_bursts, int num_reverse_bursts, size_t num_proposals) {	
-	auto contributions_and_timeouts = mac->getUsedPPDutyCycleBudget();
-	const std::vector<double> &used_pp_duty_cycle_budget = contributions_and_timeouts.first;
-	const std::vector<int> &remaining_pp_timeouts = contributions_and_timeouts.second;
+	const PPDutyCycleBudget &used_pp_duty_cycle_budget = mac->getPPDutyCycleBudget();
 	double sh_budget = mac->shouldConsiderDutyCycle() ? mac->getDutyCycle().getSHBudget(used_pp_duty_cycle_budget) : 1.0;
 	coutd << "duty cycle considerations: sh_budget=" << sh_budget*100 << "% -> ";
 	int min_offset;
 	int period;
 	try {
-		auto pair = mac->getDutyCycle().getPeriodicityPP(used_pp_duty_cycle_budget, remaining_pp_timeouts, sh_budget, next_broadcast_slot);	
+		auto pair = mac->getDutyCycle().getPeriodicityPP(used_pp_duty_cycle_budget, sh_budget, next_broadcast_slot);	
 		min_offset = pair.first;						
 		period = pair.second;	
 	} catch (const no_duty_cycle_budget_left_error &e) {
@@ -221,6 +209,14 @@ std::pair<std::vector<LinkProposal>, int> SHLinkManager::proposeLocalLinks(const
 		throw std::runtime_error(std::string(e.what()));
 	}	
 	coutd << " min_period=" << period << " -> ";			
+	// proposals found ahead of this transmission can only be used for the same parameters
+	auto precomputed_it = precomputed_link_proposals.find(dest_id);
+	PrecomputedLinkProposals precomputed;
+	bool has_precomputed = precomputed_it != precomputed_link_proposals.end();
+	if (has_precomputed) {
+		precomputed = precomputed_it->second;
+		precomputed_link_proposals.erase(precomputed_it);
+	}
 	try {
 		// the proposal should be after the other user's next broadcast slot 
 		int next_expected_broadcast = mac->getNeighborObserver().getNextExpectedBroadcastSlotOffset(dest_id);
@@ -233,34 +229,122 @@ std::pair<std::vector<LinkProposal>, int> SHLinkManager::proposeLocalLinks(const
 		min_offset = std::max(min_offset, (int) next_broadcast_slot);
 		coutd << "using own next broadcast in " << min_offset << " slots as minimum offset -> ";
 	}			
-	return {LinkProposalFinder::findLinkProposals(num_proposals, min_offset, num_forward_bursts, num_reverse_bursts, period, mac->getDefaultPPLinkTimeout(), mac->shouldLearnDmeActivity(), mac->getReservationManager(), mac), min_offset};			
+	if (has_precomputed) {
+		std::vector<LinkProposal> proposals;
+		if (usePrecomputedLinkProposals(precomputed, min_offset, period, num_forward_bursts, num_reverse_bursts, num_proposals, proposals)) {
+			coutd << "using " << proposals.size() << " precomputed proposals -> ";
+			num_precomputed_link_proposals_used++;
+			return {proposals, min_offset};
+		}
+		coutd << "precomputed proposals are stale -> ";
+	}
+	// longer periods use less of the duty cycle budget, so they are permissible, too
+	int max_period = period + num_alternative_link_proposal_periods;
+	return {LinkProposalFinder::findRankedLinkProposals(num_proposals, num_link_proposal_candidates_per_channel, min_offset, num_forward_bursts, num_reverse_bursts, period, max_period, mac->getDefaultPPLinkTimeout(), mac->getReservationManager(), mac), min_offset};			
+}
+
+bool SHLinkManager::usePrecomputedLinkProposals(const PrecomputedLinkProposals &precomputed, int min_offset, int period, int num_forward_bursts, int num_reverse_bursts, size_t num_proposals, std::vector<LinkProposal> &proposals) const {
+	uint64_t current_slot = mac->getCurrentSlot();
+	if (precomputed.transmission_slot != current_slot || precomputed.min_slot != current_slot + min_offset || precomputed.period != period || precomputed.num_proposals != num_proposals || precomputed.proposals.empty())
+		return false;
+	// normalize to the current time slot
+	proposals = precomputed.proposals;
+	for (auto &proposal : proposals)
+		proposal.slot_offset -= (int) (current_slot - precomputed.found_at_slot);
+	// idle slots stay idle while no reservation has changed
+	if (reservation_manager->getGeneration() == precomputed.generation)
+		return true;
+	std::vector<LinkProposal> links = proposals;
+	for (auto &link : links) {
+		link.num_tx_initiator = num_forward_bursts;
+		link.num_tx_recipient = num_reverse_bursts;
+	}
+	bool is_link_initiator = true;
+	const auto are_valid = reservation_manager->areLinksValid(links, mac->getDefaultPPLinkTimeout(), is_link_initiator);
+	return std::all_of(are_valid.begin(), are_valid.end(), [](bool is_valid) {return is_valid;});
+}
+
+void SHLinkManager::precomputeLinkProposals() {
+	if (!next_broadcast_scheduled || next_broadcast_slot == 0 || link_requests.empty())
+		return;
+	uint64_t current_slot = mac->getCurrentSlot(), transmission_slot = current_slot + next_broadcast_slot;
+	for (const auto &pair : link_requests) {
+		const MacId &dest_id = pair.first;
+		// up-to-date already
+		auto it = precomputed_link_proposals.find(dest_id);
+		if (it != precomputed_link_proposals.end() && it->second.transmission_slot == transmission_slot)
+			continue;
+		// advertised links will be proposed instead
+		if (!mac->getNeighborObserver().getAdvertisedLinkProposals(dest_id, current_slot).empty())
+			continue;
+		// anticipate proposeLocalLinks() at the transmission slot, where offsets are relative to that slot
+		try {
+			const PPDutyCycleBudget &used_pp_duty_cycle_budget = mac->getPPDutyCycleBudget();
+			double sh_budget = mac->shouldConsiderDutyCycle() ? mac->getDutyCycle().getSHBudget(used_pp_duty_cycle_budget) : 1.0;
+			auto pair = mac->getDutyCycle().getPeriodicityPP(used_pp_duty_cycle_budget, sh_budget, next_broadcast_slot);
+			int next_expected_broadcast = mac->getNeighborObserver().getNextExpectedBroadcastSlotOffset(dest_id);
+			PrecomputedLinkProposals precomputed;
+			precomputed.transmission_slot = transmission_slot;
+			precomputed.min_slot = std::max(std::max(current_slot + pair.first, transmission_slot), current_slot + next_expected_broadcast + 1);
+			precomputed.period = pair.second;
+			precomputed.num_proposals = num_proposals_unadvertised_link_requests;
+			precomputed.found_at_slot = current_slot;
+			precomputed.generation = reservation_manager->getGeneration();
+			precomputed.proposals = LinkProposalFinder::findRankedLinkProposals(precomputed.num_proposals, num_link_proposal_candidates_per_channel, (int) (precomputed.min_slot - current_slot), 1, 1, precomputed.period, precomputed.period + num_alternative_link_proposal_periods, mac->getDefaultPPLinkTimeout(), reservation_manager, mac);
+			coutd << "precomputed " << precomputed.proposals.size() << " proposals for " << dest_id << " -> ";
+			precomputed_link_proposals[dest_id] = precomputed;
+		} catch (const std::exception &e) {
+			// the parameters aren't known yet, so the proposals will be found at the transmission slot, and there's no need to try again until then
+			PrecomputedLinkProposals unknown;
+			unknown.transmission_slot = transmission_slot;
+			precomputed_link_proposals[dest_id] = unknown;
+		}
+	}
+}
+
+void SHLinkManager::setNumLinkProposalCandidatesPerChannel(size_t value) {
+	if (value == 0)
+		throw std::invalid_argument("SHLinkManager::setNumLinkProposalCandidatesPerChannel for zero candidates.");
+	num_link_proposal_candidates_per_channel = value;
+	precomputed_link_proposals.clear();
+}
+
+void SHLinkManager::setNumAlternativeLinkProposalPeriods(int value) {
+	if (value < 0)
+		throw std::invalid_argument("SHLinkManager::setNumAlternativeLinkProposalPeriods for negative value " + std::to_string(value) + ".");
+	num_alternative_link_proposal_periods = value;
+	precomputed_link_proposals.clear();
 }
 
 LinkProposal SHLinkManager::proposeRemoteLinks(const MacId& dest_id, int num_forward_bursts, int num_reverse_bursts) {
 	// find advertised links
-	std::vector<LinkProposal> advertisements = mac->getNeighborObserver().getAdvertisedLinkProposals(dest_id, mac->getCurrentSlot());
+	const std::vector<LinkProposal> &advertisements = mac->getNeighborObserver().getAdvertisedLinkProposals(dest_id, mac->getCurrentSlot());
 	coutd << "checking " << advertisements.size() << " advertised links -> ";
-	// compare to local reservations
-	std::vector<LinkProposal> valid_links;
-	for (const auto possible_link : advertisements) {
-		const ReservationTable *table = reservation_manager->getReservationTable(reservation_manager->getFreqChannelByCenterFreq(possible_link.center_frequency));
-		bool is_link_initiator = true;
-		bool is_valid = table->isLinkValid(possible_link.slot_offset, possible_link.period, num_forward_bursts, num_reverse_bursts, mac->getDefaultPPLinkTimeout(), is_link_initiator);
-		coutd << "link at t=" << possible_link.slot_offset << "@" << possible_link.center_frequency << "kHz is " << (is_valid ? "valid" : "invalid") << " -> ";
-		if (is_valid)
-			valid_links.push_back(possible_link);
-	}		
-	if (valid_links.empty())
-		throw std::runtime_error("SHLinkManager::proposeRemoteLinks couldn't find any valid links");
+	// compare to local reservations, all advertisements at once and with the local number of bursts
+	std::vector<LinkProposal> candidates = advertisements;
+	for (auto &candidate : candidates) {
+		candidate.num_tx_initiator = num_forward_bursts;
+		candidate.num_tx_recipient = num_reverse_bursts;
+	}
+	bool is_link_initiator = true;
+	const auto are_valid = reservation_manager->areLinksValid(candidates, mac->getDefaultPPLinkTimeout(), is_link_initiator);
 	// select earliest suitable
+	bool found_valid_link = false;
 	LinkProposal earliest_link;
 	int earliest_offset = (int) reservation_manager->getPlanningHorizon();
-	for (const auto valid_link : valid_links) {
-		if (valid_link.slot_offset < earliest_offset) {
-			earliest_link = valid_link;
-			earliest_offset = valid_link.slot_offset;
+	for (size_t i = 0; i < advertisements.size(); i++) {
+		const LinkProposal &possible_link = advertisements.at(i);
+		coutd << "link at t=" << possible_link.slot_offset << "@" << possible_link.center_frequency << "kHz is " << (are_valid.at(i) ? "valid" : "invalid") << " -> ";
+		if (!are_valid.at(i))
+			continue;
+		found_valid_link = true;
+		if (possible_link.slot_offset < earliest_offset) {
+			earliest_link = possible_link;
+			earliest_offset = possible_link.slot_offset;
 		}
 	}
+	if (!found_valid_link)
+		throw std::runtime_error("SHLinkManager::proposeRemoteLinks couldn't find any valid links");
 	coutd << "earliest link is at t=" << earliest_link.slot_offset << "@" << earliest_link.center_frequency << "kHz -> ";
 	return earliest_link;
 }
@@ -306,6 +390,8 @@ void SHLinkManager::onSlotStart(uint64_t num_slots) {
 		coutd << "scheduling next broadcast slot -> ";	
 		scheduleBroadcastSlot();
 	}
+	// (re-)compute proposals for pending link requests if the broadcast slot has changed
+	precomputeLinkProposals();
 
 	// broadcast link manager should always have a ReservationTable assigned	
 	assert(current_reservation_table != nullptr && "SHLinkManager::onSlotStart for unset ReservationTable.");
@@ -337,9 +423,11 @@ void SHLinkManager::onSlotEnd() {
 void SHLinkManager::sendLinkRequest(const MacId &dest_id) {	
 	coutd << *this << " will send link request to " << dest_id << " with next transmission -> ";	
 	// save request
-	link_requests.push_back({dest_id, mac->getCurrentSlot()});	
+	link_requests.push_back(dest_id, mac->getCurrentSlot());	
 	// schedule broadcast slot if necessary
 	notifyOutgoing(1);
+	// find proposals now rather than while the packet is assembled
+	precomputeLinkProposals();
 }
 
 // size_t SHLinkManager::cancelLinkRequest(const MacId& id) {
@@ -368,8 +456,9 @@ unsigned int SHLinkManager::getNumCandidateSlots(double target_collision_prob, u
 	// Assume that every neighbor that has been active within the contention window will again be active.
 	} else if (contention_method == ContentionMethod::randomized_slotted_aloha) {
 		// Number of active neighbors.
-		double m = (double) mac->getNeighborObserver().getNumActiveNeighbors();
-		k = std::ceil(1.0 / (1.0 - std::pow(1.0 - target_collision_prob, 1.0 / m)));
+		size_t m = mac->getNeighborObserver().getNumActiveNeighbors();
+		extendCandidateSlotTable(target_collision_prob, min, max, m);
+		k = m < candidate_slot_table.size() ? candidate_slot_table.at(m) : candidate_slot_table.back();
 		coutd << "channel access method: randomized slotted ALOHA for " << m << " active neighbors -> ";
 	// Don't make use of contention estimation in any way. Just select something out of the next MIN_CANDIDATES idle slots.
 	} else if (contention_method == ContentionMethod::naive_random_access) {
@@ -383,6 +472,31 @@ unsigned int SHLinkManager::getNumCandidateSlots(double target_collision_prob, u
 	return final_candidates;
 }
 
+unsigned int SHLinkManager::computeNumCandidateSlots(double target_collision_prob, double m) {
+	return std::ceil(1.0 / (1.0 - std::pow(1.0 - target_collision_prob, 1.0 / m)));
+}
+
+void SHLinkManager::extendCandidateSlotTable(double target_collision_prob, unsigned int min, unsigned int max, size_t num_neighbors) const {
+	if (target_collision_prob != candidate_slot_table_collision_prob || min != candidate_slot_table_min || max != candidate_slot_table_max) {
+		candidate_slot_table.clear();
+		candidate_slot_table_collision_prob = target_collision_prob;
+		candidate_slot_table_min = min;
+		candidate_slot_table_max = max;
+	}
+	// the number of candidates grows with the number of neighbors, s.t. the table can stop once the maximum is reached
+	while (candidate_slot_table.size() <= num_neighbors && (candidate_slot_table.empty() || candidate_slot_table.back() < max)) {
+		unsigned int k = computeNumCandidateSlots(target_collision_prob, (double) candidate_slot_table.size());
+		candidate_slot_table.push_back(std::min(max, std::max(min, k)));
+	}
+}
+
+const std::vector<unsigned int>& SHLinkManager::getCandidateSlotTable(size_t max_num_neighbors) const {
+	if (broadcast_target_collision_prob <= 0.0 || broadcast_target_collision_prob >= 1.0)
+		throw std::invalid_argument("SHLinkManager::getCandidateSlotTable target collision probability not between 0 and 1.");
+	extendCandidateSlotTable(broadcast_target_collision_prob, MIN_CANDIDATES, MAX_CANDIDATES, max_num_neighbors);
+	return candidate_slot_table;
+}
+
 unsigned long long SHLinkManager::nchoosek(unsigned long n, unsigned long k) const {
 	if (k == 0)
 		return 1;
@@ -390,28 +504,27 @@ unsigned long long SHLinkManager::nchoosek(unsigned long n, unsigned long k) con
 }
 
 unsigned int SHLinkManager::broadcastSlotSelection(unsigned int min_offset) {
+	PROFILE_PHASE(&mac->getSlotProfiler(), SlotProfiler::sh_broadcast_slot_selection);
 	coutd << "broadcast slot selection -> ";
 	if (current_reservation_table == nullptr)
 		throw std::runtime_error("SHLinkManager::broadcastSlotSelection for unset ReservationTable.");
 	unsigned int num_candidates = getNumCandidateSlots(this->broadcast_target_collision_prob, this->MIN_CANDIDATES, this->MAX_CANDIDATES);
 	mac->statisticReportBroadcastCandidateSlots((size_t) num_candidates);
 	coutd << "min_offset=" << (int) min_offset << " -> ";
-	std::vector<unsigned int > candidate_slots = current_reservation_table->findSHCandidates(num_candidates, (int) min_offset);
-	coutd << "found " << candidate_slots.size() << " -> ";
-	if (candidate_slots.empty()) {
-		// coutd << "printing reservations over entire planning horizon: " << std::endl << "t\tlocal\t\tTX" << std::endl;
-		// for (size_t t = 0; t < current_reservation_table->getPlanningHorizon(); t++) 
-		// 	coutd << "t=" << t << ":\t" << current_reservation_table->getReservation(t) << "\t" << reservation_manager->getTxTable()->getReservation(t) << std::endl;
+	// scan once into a buffer that keeps its capacity across calls, s.t. a single random draw selects a candidate
+	current_reservation_table->findSHCandidates(num_candidates, (int) min_offset, broadcast_candidate_slots);
+	coutd << "found " << broadcast_candidate_slots.size() << " -> ";
+	if (broadcast_candidate_slots.empty())
 		throw std::runtime_error("SHLinkManager::broadcastSlotSelection found zero candidate slots at min_offset=" + std::to_string(min_offset));
-	}
 	unsigned int selected_slot;
 	try {
-		selected_slot = candidate_slots.at(getRandomInt(0, candidate_slots.size()));	
+		selected_slot = broadcast_candidate_slots.at(getRandomInt(0, broadcast_candidate_slots.size()));
 	} catch (const std::exception &e) {
 		std::cerr << "error during broadcast slot selection when trying to get a random integer -> is the 'num-rngs' parameter in the .ini too small?" << std::endl;
 		throw std::runtime_error("error during broadcast slot selection when trying to get a random integer -> is the 'num-rngs' parameter in the .ini too small?");
 	}
 	mac->statisticReportSelectedBroadcastCandidateSlots(selected_slot);
+	mac->getTraceRingBuffer().record(TraceRingBuffer::broadcast_slot_selected, mac->getCurrentSlot(), selected_slot, broadcast_candidate_slots.size());
 	return selected_slot;
 }
 
@@ -422,17 +535,35 @@ void SHLinkManager::scheduleBroadcastSlot() {
 	}
 	unscheduleBroadcastSlot();
 	// Compute minimum slot offset to adhere to duty cycle.
-	auto contributions_and_timeouts = mac->getUsedPPDutyCycleBudget();
-	const std::vector<double> &used_pp_duty_cycle_budget = contributions_and_timeouts.first;
-	int min_offset = mac->shouldConsiderDutyCycle() ? mac->getDutyCycle().getOffsetSH(used_pp_duty_cycle_budget) : 1;	
+	int min_offset;
+	if (!mac->shouldConsiderDutyCycle())
+		min_offset = 1;
+	else if (!mac->shouldUseDutyCycleForecast())
+		min_offset = mac->getDutyCycle().getOffsetSH(mac->getPPDutyCycleBudget());
+	else {
+		// the forecast admits the earliest slot that keeps every window within the duty cycle
+		// the SH budget still spaces broadcasts out, unless it has been used up
+		int forecast_offset = mac->getDutyCycle().getEarliestConformantOffset(reservation_manager->getTxTable(), 1);
+		if (forecast_offset < 0) {
+			// every slot within the planning horizon would exceed the duty cycle in some window
+			std::stringstream ss;
+			ss << *mac << "::" << *this << " duty cycle forecast admits no broadcast slot within planning_horizon=" << reservation_manager->getPlanningHorizon();
+			throw no_duty_cycle_budget_left_error(ss.str());
+		} else {
+			try {
+				min_offset = std::max(forecast_offset, mac->getDutyCycle().getOffsetSH(mac->getPPDutyCycleBudget()));
+			} catch (const std::runtime_error &e) {
+				coutd << "no SH budget left, using duty cycle forecast -> ";
+				min_offset = forecast_offset;
+			}
+			coutd << "duty cycle forecast admits t=" << forecast_offset << " -> ";
+		}
+	}
 	if (uint32_t(min_offset) > reservation_manager->getPlanningHorizon() || min_offset < 0) {
 		std::stringstream ss;
 		ss << *mac << "::" << *this << " computed min_offset=" << min_offset << " at planning_horizon=" << reservation_manager->getPlanningHorizon();
 		if (mac->shouldConsiderDutyCycle()) {
-			ss << " considering duty cycle with PP contributions of [";
-			for (auto d : used_pp_duty_cycle_budget)
-				ss << d << ", ";
-			ss << "] with link stati: ";
+			ss << " considering duty cycle with PP contributions of " << mac->getPPDutyCycleBudget().getTotal() << " with link stati: ";
 			for (const auto &item : mac->getLinkManagers()) {
 				if (item.first != SYMBOLIC_LINK_ID_BROADCAST && item.first != SYMBOLIC_LINK_ID_BEACON) {
 					const PPLinkManager *pp = (const PPLinkManager*) item.second;
@@ -552,28 +683,23 @@ void SHLinkManager::processBroadcastMessage(const MacId& origin, L2HeaderSH*& he
 	if (!header->link_requests.empty())
 		coutd << "processing " << header->link_requests.size() << " link requests -> ";	
 	std::map<MacId, bool> already_processed_third_party_link_request = std::map<MacId, bool>();
+	// proposals destined to us are evaluated in one batch once third-party requests have locked their resources
+	std::vector<LinkProposal> own_proposals;
+	std::vector<uint64_t> own_proposals_generation_times;
 	for (const auto &link_request : header->link_requests) {
 		const MacId &dest_id = link_request.dest_id;
 		// destined to us?
 		if (dest_id == mac->getMacId()) {
 			mac->statisticReportLinkRequestReceived();
 			received_request = true;
-			const auto &proposal = link_request.proposed_link;			
 			// check if slot offset is large enough to reply in time
-			if (link_request.proposed_link.slot_offset <= next_broadcast_slot) {
+			if (link_request.proposed_link.slot_offset <= (int) next_broadcast_slot) {
 				coutd << "t=" << link_request.proposed_link.slot_offset << " would be before my next SH transmission at t=" << next_broadcast_slot << " -> NOT acceptable -> ";
 				mac->statisticReportLinkRequestRejectedDueToUnacceptableReplySlot();
 				continue;
-			}			
-			// check if any proposed link works locally
-			const ReservationTable *table = reservation_manager->getReservationTable(reservation_manager->getFreqChannelByCenterFreq(proposal.center_frequency));			
-			bool is_link_initiator = false;
-			bool is_acceptable = table->isLinkValid(proposal.slot_offset, proposal.period, proposal.num_tx_initiator, proposal.num_tx_recipient, mac->getDefaultPPLinkTimeout(), is_link_initiator) && isPPLinkDutyCycleConformant(proposal);
-			if (is_acceptable) {
-				coutd << "t=" << proposal.slot_offset << "@" << proposal.center_frequency << "kHz is acceptable -> ";
-				acceptable_links.push_back({proposal, link_request.generation_time});
-			} else
-				coutd << "t=" << proposal.slot_offset << "@" << proposal.center_frequency << "kHz is NOT acceptable -> ";
+			}
+			own_proposals.push_back(link_request.proposed_link);
+			own_proposals_generation_times.push_back(link_request.generation_time);
 		// destined to another user?
 		} else {
 			coutd << "passing link request on to 3rd-party-link -> ";
@@ -590,7 +716,21 @@ void SHLinkManager::processBroadcastMessage(const MacId& origin, L2HeaderSH*& he
 			third_party_link.processLinkRequestMessage(link_request);
 			already_processed_third_party_link_request[dest_id] = true;
 		}
-	}	
+	}
+	// check if any proposed link works locally
+	if (!own_proposals.empty()) {
+		bool is_link_initiator = false;
+		auto own_proposals_acceptable = reservation_manager->areLinksValid(own_proposals, mac->getDefaultPPLinkTimeout(), is_link_initiator);
+		const auto own_proposals_conformant = arePPLinksDutyCycleConformant(own_proposals, is_link_initiator);
+		for (size_t i = 0; i < own_proposals.size(); i++) {
+			const auto &proposal = own_proposals.at(i);
+			if (own_proposals_acceptable.at(i) && own_proposals_conformant.at(i)) {
+				coutd << "t=" << proposal.slot_offset << "@" << proposal.center_frequency << "kHz is acceptable -> ";
+				acceptable_links.push_back({proposal, own_proposals_generation_times.at(i)});
+			} else
+				coutd << "t=" << proposal.slot_offset << "@" << proposal.center_frequency << "kHz is NOT acceptable -> ";
+		}
+	}
 
 	if (received_request) {
 		auto *pp = (PPLinkManager*) mac->getLinkManager(header->src_id);
@@ -614,7 +754,7 @@ void SHLinkManager::processBroadcastMessage(const MacId& origin, L2HeaderSH*& he
 			LinkProposal normalized_proposal = LinkProposal(earliest_link);
 			normalized_proposal.slot_offset -= next_broadcast_slot;
 			coutd << "will attach link reply to next SH transmission with normalized offset t=" << normalized_proposal.slot_offset << " -> ";			
-			link_replies.push_back(L2HeaderSH::LinkReply(header->src_id, normalized_proposal));
+			link_replies.push_back(header->src_id, L2HeaderSH::LinkReply(header->src_id, normalized_proposal));
 		// start own link establishment otherwise
 		} else {
 			coutd << "no link request could be accepted, starting own link establishment -> ";
@@ -627,7 +767,7 @@ void SHLinkManager::processBroadcastMessage(const MacId& origin, L2HeaderSH*& he
 		if (header->link_reply.dest_id == mac->getMacId()) {
 			coutd << "processing link reply -> ";
 			const LinkProposal &link = header->link_reply.proposed_link;
-			if (isPPLinkDutyCycleConformant(link)) {
+			if (isPPLinkDutyCycleConformant(link, true)) {
 				auto *pp = (PPLinkManager*) mac->getLinkManager(header->src_id);			
 				pp->acceptLink(link, false, 0);
 			} else {
@@ -662,14 +802,17 @@ void SHLinkManager::assign(const FrequencyChannel* channel) {
 
 void SHLinkManager::setTargetCollisionProb(double value) {
 	this->broadcast_target_collision_prob = value;
+	candidate_slot_table.clear();
 }
 
 void SHLinkManager::setMinNumCandidateSlots(int value) {
 	MIN_CANDIDATES = value;	
+	candidate_slot_table.clear();
 }
 
 void SHLinkManager::setMaxNumCandidateSlots(int value) {
 	MAX_CANDIDATES = value;	
+	candidate_slot_table.clear();
 }
 
 void SHLinkManager::setUseContentionMethod(ContentionMethod method) {
@@ -696,12 +839,10 @@ bool SHLinkManager::isActive() const {
 }
 
 std::pair<int, int> SHLinkManager::getPPMinOffsetAndPeriod() const {
-	auto contributions_and_timeouts = mac->getUsedPPDutyCycleBudget();
-	const std::vector<double> &used_pp_duty_cycle_budget = contributions_and_timeouts.first;
-	const std::vector<int> &remaining_pp_timeouts = contributions_and_timeouts.second;	
+	const PPDutyCycleBudget &used_pp_duty_cycle_budget = mac->getPPDutyCycleBudget();
 	double sh_budget = mac->shouldConsiderDutyCycle() ? mac->getDutyCycle().getSHBudget(used_pp_duty_cycle_budget) : 1.0;
 	try {
-		auto pair = mac->getDutyCycle().getPeriodicityPP(used_pp_duty_cycle_budget, remaining_pp_timeouts, sh_budget, next_broadcast_slot);		
+		auto pair = mac->getDutyCycle().getPeriodicityPP(used_pp_duty_cycle_budget, sh_budget, next_broadcast_slot);		
 		int min_offset = pair.first;		
 		int period = mac->shouldUseFixedPPPeriod() ? mac->getFixedPPPeriod() : pair.second;
 		return {min_offset, period};
@@ -714,15 +855,41 @@ void SHLinkManager::setShouldTransmit(bool value) {
 	this->do_transmit = value;
 }
 
-bool SHLinkManager::isPPLinkDutyCycleConformant(const LinkProposal &link_proposal) const {
+bool SHLinkManager::isPPLinkDutyCycleConformant(const LinkProposal &link_proposal, bool is_link_initiator) const {
 	if (!mac->shouldConsiderDutyCycle())
 		return true;
-	auto contributions_and_timeouts = mac->getUsedPPDutyCycleBudget();
-	const std::vector<double> &used_pp_duty_cycle_budget = contributions_and_timeouts.first;	
+	// admit the link if its transmissions fit into what is already scheduled
+	if (mac->shouldUseDutyCycleForecast()) {
+		auto tx_rx_slots = SlotCalculator::calculateAlternatingBursts(link_proposal.slot_offset, link_proposal.num_tx_initiator, link_proposal.num_tx_recipient, link_proposal.period, mac->getDefaultPPLinkTimeout());
+		std::vector<int> &tx_slots = is_link_initiator ? tx_rx_slots.first : tx_rx_slots.second;
+		std::sort(tx_slots.begin(), tx_slots.end());
+		return mac->getDutyCycle().isForecastConformant(reservation_manager->getTxTable(), tx_slots);
+	}
+	return getUsedDutyCycleUnits() + getPPLinkDutyCycleUnits(link_proposal.period) <= PPDutyCycleBudget::toUnits(mac->getDutyCycle().getTotalBudget());
+}
+
+std::vector<bool> SHLinkManager::arePPLinksDutyCycleConformant(const std::vector<LinkProposal> &link_proposals, bool is_link_initiator) const {
+	std::vector<bool> are_conformant(link_proposals.size(), true);
+	if (!mac->shouldConsiderDutyCycle())
+		return are_conformant;
+	if (mac->shouldUseDutyCycleForecast()) {
+		for (size_t i = 0; i < link_proposals.size(); i++)
+			are_conformant.at(i) = isPPLinkDutyCycleConformant(link_proposals.at(i), is_link_initiator);
+		return are_conformant;
+	}
+	// the budget used by everything else is the same for all links
+	const int64_t used_units = getUsedDutyCycleUnits(), total_units = PPDutyCycleBudget::toUnits(mac->getDutyCycle().getTotalBudget());
+	for (size_t i = 0; i < link_proposals.size(); i++)
+		are_conformant.at(i) = used_units + getPPLinkDutyCycleUnits(link_proposals.at(i).period) <= total_units;
+	return are_conformant;
+}
+
+int64_t SHLinkManager::getUsedDutyCycleUnits() const {
+	const PPDutyCycleBudget &used_pp_duty_cycle_budget = mac->getPPDutyCycleBudget();
 	double sh_budget = mac->getDutyCycle().getSHBudget(used_pp_duty_cycle_budget);		
-	double sum_used_budget = sh_budget;
-	for (auto d : used_pp_duty_cycle_budget)
-		sum_used_budget += d;
-	sum_used_budget += 1.0 / (10.0 * std::pow(2.0, link_proposal.period));
-	return sum_used_budget <= mac->getDutyCycle().getTotalBudget();
+	return PPDutyCycleBudget::toUnits(sh_budget) + used_pp_duty_cycle_budget.getTotalUnits();
+}
+
+int64_t SHLinkManager::getPPLinkDutyCycleUnits(int period) {
+	return PPDutyCycleBudget::toUnits(1.0 / (10.0 * std::pow(2.0, period)));
 }
\ No newline at end of file
@@ -20,6 +20,7 @@
 #include <ContentionMethod.hpp>
 #include "LinkManager.hpp"
 #include "MovingAverage.hpp"
+#include "PendingMessageQueue.hpp"
 
 namespace TUHH_INTAIRNET_MCSOTDMA {
 	class SHLinkManager : public LinkManager {
@@ -29,6 +30,7 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		friend class SystemTests;
 		friend class ManyUsersTests;
 		friend class ThirdPartyLinkTests;
+		friend class MCSOTDMA_MacTests;
 
 	public:
 		SHLinkManager(ReservationManager *reservation_manager, MCSOTDMA_Mac *mac, unsigned int min_beacon_gap);
@@ -69,6 +71,13 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 */
 		void setUseContentionMethod(ContentionMethod method);
 
+		/**
+		 * Exposes the randomized slotted ALOHA slot selection policy.
+		 * @param max_num_neighbors The table is extended to cover this many active neighbors, unless MAX_CANDIDATES is reached before.
+		 * @return Number of candidate slots indexed by the number of active neighbors, for the configured target collision probability and candidate bounds. Neighbor counts beyond its end use its last entry.
+		 */
+		const std::vector<unsigned int>& getCandidateSlotTable(size_t max_num_neighbors) const;
+
 		/**
 		 * If 'true': always schedule the next broadcast slot and advertise it in the header.
 		 * If 'false: only schedule the next broadcast slot if there's more data queued up.
@@ -81,6 +90,16 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		 */
 		void setAdvertiseNextSlotInCurrentHeader(bool flag);						
 
+		/**
+		 * Link requests without advertised links carry proposals found locally, which are ranked across channels and periods.
+		 * @param value Maximum number of proposals per channel and period.
+		 */
+		void setNumLinkProposalCandidatesPerChannel(size_t value);
+		/**
+		 * @param value Number of periods longer than the shortest permissible one that may be proposed as alternatives.
+		 */
+		void setNumAlternativeLinkProposalPeriods(int value);
+
 		bool isNextBroadcastScheduled() const;
 		unsigned int getNextBroadcastSlot() const;
 		unsigned int getNextBeaconSlot() const;		
@@ -95,6 +114,10 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 
 	protected:
 		unsigned int getNumCandidateSlots(double target_collision_prob, unsigned int min, unsigned int max) const;
+		/** @return Number of candidate slots s.t. a broadcast collides with at most target_collision_prob with any of m active neighbors, before applying the candidate bounds. */
+		static unsigned int computeNumCandidateSlots(double target_collision_prob, double m);
+		/** Clears candidate_slot_table if the given parameters differ from those it was built for, and then extends it to cover num_neighbors. */
+		void extendCandidateSlotTable(double target_collision_prob, unsigned int min, unsigned int max, size_t num_neighbors) const;
 
 		unsigned long long nchoosek(unsigned long n, unsigned long k) const;
 
@@ -133,15 +156,42 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 
 		std::pair<int, int> getPPMinOffsetAndPeriod() const;
 
-		bool isPPLinkDutyCycleConformant(const LinkProposal &link_proposal) const;
+		/**
+		 * @param link_proposal
+		 * @param is_link_initiator Whether this user would transmit the initiator's or the recipient's bursts. Only needed if the duty cycle forecast is used.
+		 * @return Whether accepting this link keeps the duty cycle.
+		 */
+		bool isPPLinkDutyCycleConformant(const LinkProposal &link_proposal, bool is_link_initiator) const;
+		/**
+		 * Finds proposals for pending link requests ahead of the SH transmission, for the parameters that proposeLocalLinks() is expected to use then.
+		 * Only requests without proposals for the currently scheduled broadcast slot are considered.
+		 */
+		void precomputeLinkProposals();
+		class PrecomputedLinkProposals;
+		/**
+		 * @param precomputed
+		 * @param min_offset The parameters proposeLocalLinks() has determined at the transmission slot.
+		 * @param period
+		 * @param num_forward_bursts
+		 * @param num_reverse_bursts
+		 * @param num_proposals
+		 * @param proposals Is set to the precomputed proposals, normalized to the current slot.
+		 * @return Whether the precomputed proposals were found for the same parameters and are all still valid.
+		 */
+		bool usePrecomputedLinkProposals(const PrecomputedLinkProposals &precomputed, int min_offset, int period, int num_forward_bursts, int num_reverse_bursts, size_t num_proposals, std::vector<LinkProposal> &proposals) const;
+		/** Evaluates isPPLinkDutyCycleConformant() for several links, s.t. the budget used by other links is only computed once. */
+		std::vector<bool> arePPLinksDutyCycleConformant(const std::vector<LinkProposal> &link_proposals, bool is_link_initiator) const;
+		/** @return The duty cycle budget in PPDutyCycleBudget units that is used by the SH and all PP links. */
+		int64_t getUsedDutyCycleUnits() const;
+		/** @return The duty cycle budget in PPDutyCycleBudget units that a PP link of this period would use. */
+		static int64_t getPPLinkDutyCycleUnits(int period);
 
 	protected:
-		/** Collection of link requests that should be broadcast as soon as possible. */
+		/** Collection of link requests that should be broadcast as soon as possible, as <destination, generation time> pairs. */
 		// std::vector<std::pair<L2HeaderLinkRequest*, LinkEstablishmentPayload*>> link_requests;
-		std::vector<std::pair<MacId, uint64_t>> link_requests;
-		std::vector<L2HeaderSH::LinkReply> link_replies;
-		/** Collection of link replies and corresponding time slots where they should be transmitted. */
-		// std::vector<std::pair<unsigned int, std::pair<L2HeaderLinkReply*, LinkEstablishmentPayload*>>> link_replies;				
+		PendingMessageQueue<uint64_t> link_requests;
+		/** Collection of link replies, one of which is attached to each SH transmission. */
+		PendingMessageQueue<L2HeaderSH::LinkReply> link_replies;
 		/** Target collision probability for non-beacon broadcasts. */
 		double broadcast_target_collision_prob = .626;
 		/** Whether the next broadcast slot has been scheduled. */
@@ -156,12 +206,42 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		unsigned int MIN_CANDIDATES = 3;
 		/** Maximum number of slots to consider during slot selection. */
 		unsigned int MAX_CANDIDATES = 10000;
+		/** Bounded number of candidate slots by number of active neighbors, which is extended as more neighbors are observed. */
+		mutable std::vector<unsigned int> candidate_slot_table;
+		/** Parameters that candidate_slot_table was built for. */
+		mutable double candidate_slot_table_collision_prob = 0.0;
+		mutable unsigned int candidate_slot_table_min = 0, candidate_slot_table_max = 0;
+		/** Candidate slots of the current broadcast slot selection, kept s.t. their capacity is reused. */
+		std::vector<unsigned int> broadcast_candidate_slots;
 		MovingAverage avg_num_slots_inbetween_packet_generations;
 		unsigned int num_slots_since_last_packet_generation = 0;
 		bool packet_generated_this_slot = false;
 		ContentionMethod contention_method = randomized_slotted_aloha;
 		/** No. of proposed links when no advertisements are available */
 		size_t num_proposals_unadvertised_link_requests = 3;
+		/** Locally-found proposals per channel and period, ranked s.t. each channel's best comes first. */
+		size_t num_link_proposal_candidates_per_channel = 1;
+		/** Periods beyond the shortest permissible one that are considered for locally-found proposals. */
+		int num_alternative_link_proposal_periods = 0;
+		/** Locally-usable proposals found ahead of the SH transmission that carries a link request. */
+		class PrecomputedLinkProposals {
+		public:
+			/** Absolute time slot of the SH transmission these were found for. */
+			uint64_t transmission_slot = 0;
+			/** Absolute time slot from which links could start. */
+			uint64_t min_slot = 0;
+			int period = 0;
+			size_t num_proposals = 0;
+			/** Absolute time slot that the proposals' offsets are relative to. */
+			uint64_t found_at_slot = 0;
+			/** ReservationManager::getGeneration() at that time. */
+			uint64_t generation = 0;
+			std::vector<LinkProposal> proposals;
+		};
+		/** Precomputed proposals by link request destination. */
+		std::map<MacId, PrecomputedLinkProposals> precomputed_link_proposals;
+		/** Number of link requests whose proposals were taken from 'precomputed_link_proposals' instead of being found at the transmission slot. */
+		size_t num_precomputed_link_proposals_used = 0;
 	};
 }
 
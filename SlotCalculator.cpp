@@ -19,6 +19,11 @@
 #include "SlotCalculator.hpp"
 #include <iostream>
 #include <cmath>
+#include <map>
+#include <tuple>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
 
 using namespace TUHH_INTAIRNET_MCSOTDMA;
 
@@ -41,23 +46,52 @@ std::pair<std::vector<int>, std::vector<int>> SlotCalculator::calculateTxRxSlots
 	return tx_rx_slots;
 }
 
-std::pair<std::vector<int>, std::vector<int>> SlotCalculator::calculateAlternatingBursts(const int &start_slot_offset, const int &num_forward_bursts, const int &num_reverse_bursts, const int &period, const int &timeout) {
-	auto tx_rx_slots = std::pair<std::vector<int>, std::vector<int>>();
-	auto &tx_slots = tx_rx_slots.first;
-	auto &rx_slots = tx_rx_slots.second;
-	int increment = 5*std::pow(2, period);		
-	int slot = start_slot_offset;
+int SlotCalculator::getBurstIncrement(const int &period) {
+	if (period >= 0 && period < NUM_TABULATED_PERIODS)
+		return BURST_INCREMENTS[period];
+	return 5*std::pow(2, period);
+}
+
+SlotCalculator::BurstSlots::BurstSlots(const std::vector<int> &offsets, int start_slot_offset) : first(offsets.data()), last(offsets.data() + offsets.size()), start_slot_offset(start_slot_offset) {
+	// skip those that lie in the past
+	first = std::lower_bound(first, last, -start_slot_offset);
+}
+
+int SlotCalculator::BurstSlots::at(size_t i) const {
+	if (i >= size())
+		throw std::out_of_range("BurstSlots::at(" + std::to_string(i) + ") for view of size " + std::to_string(size()));
+	return start_slot_offset + first[i];
+}
+
+const SlotCalculator::BurstPattern& SlotCalculator::getAlternatingBurstPattern(const int &num_forward_bursts, const int &num_reverse_bursts, const int &period, const int &timeout) {
+	// each thread keeps its own cache, s.t. lookups need no synchronization
+	static thread_local std::map<std::tuple<int, int, int, int>, BurstPattern> cache;
+	const auto key = std::make_tuple(period, num_forward_bursts, num_reverse_bursts, timeout);
+	auto it = cache.find(key);
+	if (it != cache.end())
+		return it->second;
+	BurstPattern pattern;
+	int increment = getBurstIncrement(period);
+	int slot = 0;
 	for (int exchange = 0; exchange < timeout; exchange++) {				
 		for (int fw_burst = 0; fw_burst < num_forward_bursts; fw_burst++) {
-			if (slot >= 0)
-				tx_slots.push_back(slot);
+			pattern.tx_offsets.push_back(slot);
 			slot += increment;
 		}
 		for (int rv_burst = 0; rv_burst < num_reverse_bursts; rv_burst++) {
-			if (slot >= 0)
-				rx_slots.push_back(slot);
+			pattern.rx_offsets.push_back(slot);
 			slot += increment;
 		}
 	}
-	return tx_rx_slots;	
-}
\ No newline at end of file
+	return cache.emplace(key, std::move(pattern)).first->second;
+}
+
+std::pair<SlotCalculator::BurstSlots, SlotCalculator::BurstSlots> SlotCalculator::viewAlternatingBursts(const int &start_slot_offset, const int &num_forward_bursts, const int &num_reverse_bursts, const int &period, const int &timeout) {
+	const BurstPattern &pattern = getAlternatingBurstPattern(num_forward_bursts, num_reverse_bursts, period, timeout);
+	return {BurstSlots(pattern.tx_offsets, start_slot_offset), BurstSlots(pattern.rx_offsets, start_slot_offset)};
+}
+
+std::pair<std::vector<int>, std::vector<int>> SlotCalculator::calculateAlternatingBursts(const int &start_slot_offset, const int &num_forward_bursts, const int &num_reverse_bursts, const int &period, const int &timeout) {
+	const auto views = viewAlternatingBursts(start_slot_offset, num_forward_bursts, num_reverse_bursts, period, timeout);
+	return {std::vector<int>(views.first.begin(), views.first.end()), std::vector<int>(views.second.begin(), views.second.end())};
+}
@@ -17,8 +17,78 @@
 #ifndef TUHH_INTAIRNET_MC_SOTDMA_SLOTCALCULATOR_HPP
 #define TUHH_INTAIRNET_MC_SOTDMA_SLOTCALCULATOR_HPP
 
+#include <utility>
+#include <vector>
+#include <iterator>
+#include <cstddef>
+
 namespace TUHH_INTAIRNET_MCSOTDMA::SlotCalculator {
 
+/** Number of periods for which the slot increment in-between bursts is tabulated at compile time. */
+constexpr int NUM_TABULATED_PERIODS = 16;
+/** Slot increments 5*2^period in-between two bursts, for the tabulated periods. */
+constexpr int BURST_INCREMENTS[NUM_TABULATED_PERIODS] = {5, 10, 20, 40, 80, 160, 320, 640, 1280, 2560, 5120, 10240, 20480, 40960, 81920, 163840};
+
+/** @return The number of slots in-between two bursts, i.e. 5*2^period. */
+int getBurstIncrement(const int &period);
+
+/** Offsets of all burst starts of an alternating burst pattern, relative to its first burst. */
+class BurstPattern {
+public:
+	std::vector<int> tx_offsets, rx_offsets;
+};
+
+/** Non-owning view onto the offsets of a cached BurstPattern, shifted by a start slot offset. Resulting slots that would lie in the past are skipped. */
+class BurstSlots {
+public:
+	class const_iterator {
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef int value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const int* pointer;
+		typedef int reference;
+
+		const_iterator(const int *offset, int start_slot_offset) : offset(offset), start_slot_offset(start_slot_offset) {}
+		int operator*() const {return start_slot_offset + *offset;}
+		const_iterator& operator++() {++offset; return *this;}
+		const_iterator operator++(int) {const_iterator copy = *this; ++offset; return copy;}
+		bool operator==(const const_iterator &other) const {return offset == other.offset;}
+		bool operator!=(const const_iterator &other) const {return offset != other.offset;}
+
+	protected:
+		const int *offset;
+		int start_slot_offset;
+	};
+
+	/**
+	 * @param offsets Ascending offsets relative to the first burst. Must outlive this view.
+	 * @param start_slot_offset Slot offset of the first burst.
+	 */
+	BurstSlots(const std::vector<int> &offsets, int start_slot_offset);
+
+	const_iterator begin() const {return const_iterator(first, start_slot_offset);}
+	const_iterator end() const {return const_iterator(last, start_slot_offset);}
+	size_t size() const {return last - first;}
+	bool empty() const {return first == last;}
+	/** @return The i-th non-negative slot offset. */
+	int at(size_t i) const;
+	int getStartSlotOffset() const {return start_slot_offset;}
+
+protected:
+	const int *first, *last;
+	int start_slot_offset;
+};
+
+/**
+ * Patterns are computed once per combination of parameters and then served from a per-thread cache.
+ * @return The cached pattern, which stays valid for the lifetime of the calling thread.
+ */
+const BurstPattern& getAlternatingBurstPattern(const int &num_forward_bursts, const int &num_reverse_bursts, const int &period, const int &timeout);
+
+/** Allocation-free counterpart of calculateAlternatingBursts(). @return Views onto the link initiator's TX and RX slots. */
+std::pair<BurstSlots, BurstSlots> viewAlternatingBursts(const int &start_slot_offset, const int &num_forward_bursts, const int &num_reverse_bursts, const int &period, const int &timeout);
+
 std::pair<std::vector<int>, std::vector<int>> calculateTxRxSlots(const int &start_slot_offset, const int &burst_length, const int &burst_length_tx, const int &burst_length_rx, const int &burst_offset, const int &timeout);
 
 std::pair<std::vector<int>, std::vector<int>> calculateAlternatingBursts(const int &start_slot_offset, const int &num_forward_bursts, const int &num_reverse_bursts, const int &period, const int &timeout);
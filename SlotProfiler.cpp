@@ -0,0 +1,70 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <stdexcept>
+#include <algorithm>
+#include "SlotProfiler.hpp"
+
+using namespace TUHH_INTAIRNET_MCSOTDMA;
+
+const LatencyHistogram SlotProfiler::empty_histogram = LatencyHistogram();
+
+void SlotProfiler::record(Phase phase, uint64_t duration_ns) {
+	if (phase >= num_phases)
+		throw std::invalid_argument("SlotProfiler::record for invalid phase " + std::to_string(phase));
+	if (profiles.empty())
+		profiles.resize(num_phases);
+	auto &profile = profiles[phase];
+	profile.count++;
+	profile.total += duration_ns;
+	profile.max = std::max(profile.max, duration_ns);
+	profile.histogram.record((double) duration_ns);
+}
+
+uint64_t SlotProfiler::getCount(Phase phase) const {
+	return profiles.empty() ? 0 : profiles.at(phase).count;
+}
+
+uint64_t SlotProfiler::getTotal(Phase phase) const {
+	return profiles.empty() ? 0 : profiles.at(phase).total;
+}
+
+uint64_t SlotProfiler::getMax(Phase phase) const {
+	return profiles.empty() ? 0 : profiles.at(phase).max;
+}
+
+const LatencyHistogram& SlotProfiler::getHistogram(Phase phase) const {
+	return profiles.empty() ? empty_histogram : profiles.at(phase).histogram;
+}
+
+void SlotProfiler::reset() {
+	profiles.clear();
+}
+
+std::string SlotProfiler::getPhaseName(Phase phase) {
+	switch (phase) {
+		case mac_update: return "mac_update";
+		case mac_execute: return "mac_execute";
+		case mac_on_slot_end: return "mac_on_slot_end";
+		case link_manager_on_slot_start: return "link_manager_on_slot_start";
+		case link_manager_on_slot_end: return "link_manager_on_slot_end";
+		case sh_broadcast_slot_selection: return "sh_broadcast_slot_selection";
+		case link_proposal_finder_find_link_proposals: return "link_proposal_finder_find_link_proposals";
+		case reservation_table_update: return "reservation_table_update";
+		default: throw std::invalid_argument("SlotProfiler::getPhaseName for invalid phase " + std::to_string(phase));
+	}
+}
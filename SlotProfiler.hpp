@@ -0,0 +1,108 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef TUHH_INTAIRNET_MC_SOTDMA_SLOTPROFILER_HPP
+#define TUHH_INTAIRNET_MC_SOTDMA_SLOTPROFILER_HPP
+
+#include <vector>
+#include <chrono>
+#include <string>
+#include "LatencyHistogram.hpp"
+
+/**
+ * Scoped timers are only compiled in if MCSOTDMA_PROFILING is defined, e.g. through the CMake option of the same name.
+ * Otherwise, PROFILE_PHASE expands to nothing and adds no overhead.
+ */
+#ifdef MCSOTDMA_PROFILING
+	#define PROFILE_PHASE(profiler, phase) TUHH_INTAIRNET_MCSOTDMA::ScopedPhaseTimer scoped_phase_timer(profiler, phase)
+#else
+	#define PROFILE_PHASE(profiler, phase)
+#endif
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+
+	/**
+	 * Aggregates how long each phase of a time slot takes on one user: number of calls, total and maximum duration, and a histogram of durations.
+	 */
+	class SlotProfiler {
+
+		friend class SlotProfilerTests;
+
+	public:
+		enum Phase {
+			mac_update,
+			mac_execute,
+			mac_on_slot_end,
+			link_manager_on_slot_start,
+			link_manager_on_slot_end,
+			sh_broadcast_slot_selection,
+			link_proposal_finder_find_link_proposals,
+			reservation_table_update,
+			/** not a phase, but the number of phases */
+			num_phases
+		};
+
+		/**
+		 * @param phase
+		 * @param duration_ns Duration of one execution of this phase in nanoseconds.
+		 */
+		void record(Phase phase, uint64_t duration_ns);
+
+		uint64_t getCount(Phase phase) const;
+		/** @return Summed duration in nanoseconds. */
+		uint64_t getTotal(Phase phase) const;
+		/** @return Longest duration in nanoseconds. */
+		uint64_t getMax(Phase phase) const;
+		/** @return Histogram of durations in nanoseconds. */
+		const LatencyHistogram& getHistogram(Phase phase) const;
+		void reset();
+
+		static std::string getPhaseName(Phase phase);
+
+	protected:
+		class PhaseProfile {
+		public:
+			uint64_t count = 0, total = 0, max = 0;
+			LatencyHistogram histogram;
+		};
+
+		/** Allocated upon the first record(), s.t. users that are never profiled don't pay for the histograms. */
+		std::vector<PhaseProfile> profiles;
+		static const LatencyHistogram empty_histogram;
+	};
+
+	/** Measures the time between its construction and destruction and records it with a SlotProfiler. */
+	class ScopedPhaseTimer {
+	public:
+		ScopedPhaseTimer(SlotProfiler *profiler, SlotProfiler::Phase phase) : profiler(profiler), phase(phase), start(std::chrono::steady_clock::now()) {}
+
+		~ScopedPhaseTimer() {
+			if (profiler != nullptr)
+				profiler->record(phase, (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+		ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+	protected:
+		SlotProfiler *profiler;
+		SlotProfiler::Phase phase;
+		std::chrono::steady_clock::time_point start;
+	};
+}
+
+#endif //TUHH_INTAIRNET_MC_SOTDMA_SLOTPROFILER_HPP
@@ -0,0 +1,79 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <stdexcept>
+#include "StatisticRegistry.hpp"
+
+using namespace TUHH_INTAIRNET_MCSOTDMA;
+
+StatisticRegistry::StatisticRegistry(unsigned int emission_interval) : emission_interval(emission_interval) {
+	if (emission_interval == 0)
+		throw std::invalid_argument("StatisticRegistry emission interval must be positive.");
+}
+
+void StatisticRegistry::add(TrackedStatistic *stat) {
+	if (stat->registry != nullptr)
+		throw std::invalid_argument("StatisticRegistry::add for statistic at index " + std::to_string(stat->index) + " that is already registered.");
+	stat->registry = this;
+	stat->index = statistics.size();
+	statistics.push_back(stat);
+	is_dirty.push_back(false);
+	dirty_indices.reserve(statistics.size());
+}
+
+void StatisticRegistry::markDirty(size_t index) {
+	if (!is_dirty[index]) {
+		is_dirty[index] = true;
+		dirty_indices.push_back(index);
+	}
+}
+
+size_t StatisticRegistry::update(size_t num_slots) {
+	num_slots_since_emission += num_slots;
+	if (num_slots_since_emission < emission_interval)
+		return 0;
+	num_slots_since_emission = 0;
+	return flush();
+}
+
+size_t StatisticRegistry::flush() {
+	size_t num_emitted = dirty_indices.size();
+	for (size_t index : dirty_indices) {
+		statistics[index]->update();
+		is_dirty[index] = false;
+	}
+	dirty_indices.clear();
+	return num_emitted;
+}
+
+void StatisticRegistry::setEmissionInterval(unsigned int value) {
+	if (value == 0)
+		throw std::invalid_argument("StatisticRegistry emission interval must be positive.");
+	this->emission_interval = value;
+}
+
+unsigned int StatisticRegistry::getEmissionInterval() const {
+	return emission_interval;
+}
+
+size_t StatisticRegistry::size() const {
+	return statistics.size();
+}
+
+size_t StatisticRegistry::getNumDirty() const {
+	return dirty_indices.size();
+}
@@ -0,0 +1,110 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef TUHH_INTAIRNET_MC_SOTDMA_STATISTICREGISTRY_HPP
+#define TUHH_INTAIRNET_MC_SOTDMA_STATISTICREGISTRY_HPP
+
+#include <vector>
+#include <string>
+#include <Statistic.hpp>
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+
+	class TrackedStatistic;
+
+	/**
+	 * Keeps track of which of its Statistics have changed since they were last emitted.
+	 * Only those are updated, and only once every 'emission_interval' slots, s.t. the per-slot cost is proportional to what changed.
+	 * Statistics are referred to by index, s.t. no names are stored in addition to those the Statistics hold.
+	 */
+	class StatisticRegistry {
+
+		friend class StatisticRegistryTests;
+
+	public:
+		explicit StatisticRegistry(unsigned int emission_interval = 1);
+
+		void add(TrackedStatistic *stat);
+
+		/** Called by a TrackedStatistic whenever its value changes. */
+		void markDirty(size_t index);
+
+		/**
+		 * Notify the registry that time has passed. Emits all dirty statistics once the emission interval has passed.
+		 * @param num_slots
+		 * @return Number of statistics that were emitted.
+		 */
+		size_t update(size_t num_slots);
+
+		/**
+		 * Emits all dirty statistics immediately.
+		 * @return Number of statistics that were emitted.
+		 */
+		size_t flush();
+
+		/**
+		 * @param value Number of slots between two emissions.
+		 * @throws std::invalid_argument if zero.
+		 */
+		void setEmissionInterval(unsigned int value);
+		unsigned int getEmissionInterval() const;
+
+		size_t size() const;
+		size_t getNumDirty() const;
+
+	protected:
+		std::vector<TrackedStatistic*> statistics;
+		/** Per statistic, whether it changed since its last emission. */
+		std::vector<bool> is_dirty;
+		/** Indices of those statistics that changed since the last emission. */
+		std::vector<size_t> dirty_indices;
+		unsigned int emission_interval;
+		unsigned int num_slots_since_emission = 0;
+	};
+
+	/**
+	 * A Statistic that notifies its StatisticRegistry whenever its value changes.
+	 */
+	class TrackedStatistic : public Statistic {
+
+		friend class StatisticRegistry;
+
+	public:
+		TrackedStatistic(const std::string& name, IOmnetPluggable *pluggable) : Statistic(name, pluggable) {}
+
+		void capture(double value) {
+			Statistic::capture(value);
+			markDirty();
+		}
+
+		void increment() {
+			Statistic::increment();
+			markDirty();
+		}
+
+	protected:
+		void markDirty() {
+			if (registry != nullptr)
+				registry->markDirty(index);
+		}
+
+		StatisticRegistry *registry = nullptr;
+		size_t index = 0;
+	};
+}
+
+#endif //TUHH_INTAIRNET_MC_SOTDMA_STATISTICREGISTRY_HPP
@@ -25,6 +25,10 @@ using namespace TUHH_INTAIRNET_MCSOTDMA;
 ThirdPartyLink::ThirdPartyLink(const MacId& id_link_initiator, const MacId& id_link_recipient, MCSOTDMA_Mac *mac) 
 	: id_link_initiator(id_link_initiator), id_link_recipient(id_link_recipient), locked_resources_for_initiator(), locked_resources_for_recipient(), mac(mac) {}
 
+ThirdPartyLink::~ThirdPartyLink() {
+	unindexResources();
+}
+
 ThirdPartyLink::Status ThirdPartyLink::getStatus() const {
 	return this->status;
 }
@@ -59,6 +63,11 @@ void ThirdPartyLink::onSlotStart(size_t num_slots) {
 	// update normalization offset
 	if (normalization_offset != UNSET)
 		normalization_offset++;
+	// keep track of how long this link has been idle
+	if (status == uninitialized)
+		num_idle_slots += num_slots;
+	else
+		num_idle_slots = 0;
 }
 
 void ThirdPartyLink::onSlotEnd() {
@@ -78,7 +87,17 @@ void ThirdPartyLink::onSlotEnd() {
 
 void ThirdPartyLink::reset() {
 	coutd << *this << " resetting -> ";
+	mac->traceLinkMilestone("ThirdPartyLink::reset", id_link_initiator, id_link_recipient, TraceRingBuffer::third_party_link_reset, id_link_initiator.getId(), id_link_recipient.getId());
 	this->status = uninitialized;
+	// remember what is about to be freed, s.t. only overlapping links have to be notified
+	freed_resources.clear();
+	for (const auto &pair : locked_resources_for_initiator.getRemainingResources())
+		freed_resources.push_back(pair);
+	for (const auto &pair : locked_resources_for_recipient.getRemainingResources())
+		freed_resources.push_back(pair);
+	for (const auto &pair : scheduled_resources.getRemainingResources())
+		freed_resources.push_back(pair);
+	unindexResources();
 	// unlock and unschedule everything
 	size_t unlocks = locked_resources_for_initiator.unlock_either_id(id_link_initiator, id_link_recipient);
 	coutd << "unlocked " << unlocks << " initiator locks -> ";
@@ -97,6 +116,31 @@ void ThirdPartyLink::reset() {
 	link_description = LinkDescription();
 }
 
+const std::vector<std::pair<const ReservationTable*, int>>& ThirdPartyLink::getFreedResources() const {
+	return freed_resources;
+}
+
+unsigned int ThirdPartyLink::getNumIdleSlots() const {
+	return num_idle_slots;
+}
+
+void ThirdPartyLink::indexResources(const ReservationTable *table, const std::vector<int> &slot_offsets) {
+	const uint64_t current_slot = mac->getCurrentSlot();
+	for (int slot_offset : slot_offsets) {
+		if (slot_offset < 0)
+			continue;
+		std::pair<const ReservationTable*, uint64_t> resource = {table, current_slot + slot_offset};
+		indexed_resources.push_back(resource);
+		mac->addToThirdPartyLinkIndex(resource, this);
+	}
+}
+
+void ThirdPartyLink::unindexResources() {
+	for (const auto &resource : indexed_resources)
+		mac->removeFromThirdPartyLinkIndex(resource, this);
+	indexed_resources.clear();
+}
+
 const MacId& ThirdPartyLink::getIdLinkInitiator() const {
 	return id_link_initiator;
 }
@@ -138,6 +182,17 @@ void ThirdPartyLink::processLinkRequestMessage(const L2HeaderSH::LinkRequest& he
 	// lock as much as possible
 	normalization_offset = 0; // request reception is the reference time
 	this->lockIfPossible(this->locked_resources_for_initiator, this->locked_resources_for_recipient, link_proposal, normalization_offset, timeout);
+	// register all proposed resources, s.t. this link is notified if any of them are freed by another link
+	try {
+		const auto *table = mac->getReservationManager()->getReservationTable(mac->getReservationManager()->getFreqChannelByCenterFreq(link_proposal.center_frequency));
+		auto slots = SlotCalculator::calculateAlternatingBursts(link_proposal.slot_offset, link_proposal.num_tx_initiator, link_proposal.num_tx_recipient, link_proposal.period, timeout);
+		indexResources(table, slots.first);
+		indexResources(table, slots.second);
+	} catch (const std::exception &e) {
+		std::stringstream ss;
+		ss << *mac << "::" << *this << "::processLinkRequestMessage error while indexing proposed resources: " << e.what();
+		throw std::runtime_error(ss.str());
+	}
 	coutd << "locked " << locked_resources_for_initiator.size() << " initiator resources and " << locked_resources_for_recipient.size() << " recipient resources -> ";
 }
 
@@ -152,7 +207,7 @@ void ThirdPartyLink::lockIfPossible(ReservationMap& locks_initiator, Reservation
 		throw std::runtime_error(ss.str());
 	}	
 	// get time slots	
-	auto slots = SlotCalculator::calculateAlternatingBursts(proposed_link.slot_offset - normalization_offset, proposed_link.num_tx_initiator, proposed_link.num_tx_recipient, proposed_link.period, timeout);
+	const auto slots = SlotCalculator::viewAlternatingBursts(proposed_link.slot_offset - normalization_offset, proposed_link.num_tx_initiator, proposed_link.num_tx_recipient, proposed_link.period, timeout);
 	ReservationTable *table = mac->getReservationManager()->getReservationTable(channel);		
 	const auto &tx_slots = slots.first;
 	const auto &rx_slots = slots.second;
@@ -253,6 +308,12 @@ void ThirdPartyLink::processLinkReplyMessage(const L2HeaderSH::LinkReply& header
 		ss << *mac << "::" << *this << "::processLinkReplyMessage couldn't schedule resources along this link: error during 'scheduleIfPossible': " << e.what();
 		throw std::runtime_error(ss.str());
 	}
+	// only the link's resources are of interest from now on
+	unindexResources();
+	std::vector<int> reserved_slots;
+	for (const auto &pair : reservations)
+		reserved_slots.push_back(pair.first);
+	indexResources(table, reserved_slots);
 	// reset counters
 	num_slots_until_expected_link_reply = UNSET;	
 	// set new counter
@@ -48,7 +48,13 @@ class ThirdPartyLink {
 		};
 
 		ThirdPartyLink(const MacId &id_link_initiator, const MacId &id_link_recipient, MCSOTDMA_Mac *mac);
-		
+		/** Unregisters from the MAC's resource index, which refers to this instance by address, so copies and moves are not allowed. */
+		~ThirdPartyLink();
+		ThirdPartyLink(const ThirdPartyLink &other) = delete;
+		ThirdPartyLink(ThirdPartyLink &&other) = delete;
+		ThirdPartyLink& operator=(const ThirdPartyLink &other) = delete;
+		ThirdPartyLink& operator=(ThirdPartyLink &&other) = delete;
+
 		void onSlotStart(size_t num_slots);
 		void onSlotEnd();
 
@@ -61,8 +67,12 @@ class ThirdPartyLink {
 		const MacId& getIdLinkRecipient() const;
 		bool operator==(const ThirdPartyLink &other);
 		bool operator!=(const ThirdPartyLink &other);
-		ThirdPartyLink::Status getStatus() const;		
+		ThirdPartyLink::Status getStatus() const;
 		void reset();
+		/** @return Resources that were unlocked or unscheduled during the last reset(), with slot offsets normalized to the time slot of that reset. */
+		const std::vector<std::pair<const ReservationTable*, int>>& getFreedResources() const;
+		/** @return Number of time slots this link has been uninitialized for. */
+		unsigned int getNumIdleSlots() const;
 
 	protected:		
 		/**
@@ -79,6 +89,14 @@ class ThirdPartyLink {
 		 */
 		void lockIfPossible(ReservationMap& locks_initiator, ReservationMap& locks_recipient, const LinkProposal &link_proposal, const int &normalization_offset, const int &timeout);
 		ReservationMap scheduleIfPossible(const std::vector<std::pair<int, Reservation>>& reservations, ReservationTable *table);
+		/**
+		 * Registers resources with the MAC's overlap index, s.t. this link is notified when another ThirdPartyLink frees any of them.
+		 * @param table
+		 * @param slot_offsets Offsets relative to the current time slot.
+		 */
+		void indexResources(const ReservationTable *table, const std::vector<int> &slot_offsets);
+		/** Removes all of this link's resources from the MAC's overlap index. */
+		void unindexResources();
 
 	protected:
 		class LinkDescription {
@@ -129,6 +147,12 @@ class ThirdPartyLink {
 		int link_expiry_offset = UNSET;
 		/** Set when a request or reply has been received, and then incremented each slot. */
 		int normalization_offset = UNSET;
+		/** Incremented each slot while the link is uninitialized, s.t. the MAC can evict idle links. */
+		unsigned int num_idle_slots = 0;
+		/** <table, absolute time slot> pairs this link has registered with the MAC's overlap index. */
+		std::vector<std::pair<const ReservationTable*, uint64_t>> indexed_resources;
+		/** Resources that were unlocked or unscheduled during the last reset. */
+		std::vector<std::pair<const ReservationTable*, int>> freed_resources;
 		MCSOTDMA_Mac *mac;
 		LinkDescription link_description;
 };
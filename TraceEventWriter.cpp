@@ -0,0 +1,92 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <fstream>
+#include <stdexcept>
+#include "TraceEventWriter.hpp"
+
+using namespace TUHH_INTAIRNET_MCSOTDMA;
+
+TraceEventWriter::TraceEventWriter(int process_id, size_t max_num_events) : process_id(process_id), max_num_events(max_num_events), start_time(std::chrono::steady_clock::now()) {}
+
+bool TraceEventWriter::add(const char *name, char phase, uint64_t slot, int id1, int id2, size_t num_reserved) {
+	if (events.size() + num_reserved >= max_num_events) {
+		num_dropped_events++;
+		return false;
+	}
+	uint64_t timestamp_us = (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+	events.push_back({name, phase, timestamp_us, slot, id1, id2});
+	return true;
+}
+
+void TraceEventWriter::begin(const char *name, uint64_t slot) {
+	// spans within a dropped one are dropped as well, s.t. end() can tell which end events to drop
+	if (num_dropped_open_spans == 0 && add(name, 'B', slot, 0, 0, num_open_spans + 1))
+		num_open_spans++;
+	else {
+		if (num_dropped_open_spans > 0)
+			num_dropped_events++;
+		num_dropped_open_spans++;
+	}
+}
+
+void TraceEventWriter::end(const char *name, uint64_t slot) {
+	if (num_dropped_open_spans > 0) {
+		num_dropped_open_spans--;
+		num_dropped_events++;
+		return;
+	}
+	// capacity has been reserved for this one
+	if (num_open_spans > 0)
+		num_open_spans--;
+	add(name, 'E', slot, 0, 0, num_open_spans);
+}
+
+void TraceEventWriter::instant(const char *name, uint64_t slot, int id1, int id2) {
+	add(name, 'i', slot, id1, id2, num_open_spans);
+}
+
+void TraceEventWriter::write(std::ostream &stream) const {
+	stream << "{\"traceEvents\":[";
+	for (size_t i = 0; i < events.size(); i++) {
+		const auto &event = events[i];
+		if (i > 0)
+			stream << ",";
+		stream << "\n{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.timestamp_us << ",\"pid\":" << process_id << ",\"tid\":0";
+		if (event.phase == 'i')
+			stream << ",\"s\":\"p\",\"args\":{\"slot\":" << event.slot << ",\"id1\":" << event.id1 << ",\"id2\":" << event.id2 << "}";
+		else
+			stream << ",\"args\":{\"slot\":" << event.slot << "}";
+		stream << "}";
+	}
+	stream << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" << num_dropped_events << "}}\n";
+}
+
+void TraceEventWriter::flush(const std::string &filename) {
+	std::ofstream file(filename);
+	if (!file.is_open())
+		throw std::runtime_error("TraceEventWriter::flush couldn't open file '" + filename + "'.");
+	write(file);
+}
+
+size_t TraceEventWriter::getNumEvents() const {
+	return events.size();
+}
+
+size_t TraceEventWriter::getNumDroppedEvents() const {
+	return num_dropped_events;
+}
@@ -0,0 +1,118 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef TUHH_INTAIRNET_MC_SOTDMA_TRACEEVENTWRITER_HPP
+#define TUHH_INTAIRNET_MC_SOTDMA_TRACEEVENTWRITER_HPP
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <ostream>
+#include <cstdint>
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+
+	/**
+	 * Buffers begin/end events of slot phases and instant events of link milestones in memory,
+	 * and writes them in the Chrome trace event format, which can be loaded into chrome://tracing or Perfetto.
+	 * Event names must be string literals, s.t. recording an event doesn't allocate.
+	 * Begin and end events must be nested, as with ScopedTraceEvent. Capacity is reserved for the end events of open spans, s.t. every recorded begin event is terminated.
+	 */
+	class TraceEventWriter {
+
+		friend class TraceEventWriterTests;
+
+	public:
+		/**
+		 * @param process_id Shown as the process in the trace viewer, e.g. the user's MAC ID.
+		 * @param max_num_events Further events are dropped once this many are buffered or reserved for end events.
+		 */
+		TraceEventWriter(int process_id, size_t max_num_events);
+
+		void begin(const char *name, uint64_t slot);
+		void end(const char *name, uint64_t slot);
+		/**
+		 * @param name
+		 * @param slot
+		 * @param id1 E.g. the link initiator.
+		 * @param id2 E.g. the link recipient.
+		 */
+		void instant(const char *name, uint64_t slot, int id1, int id2);
+
+		/** Writes all buffered events as a JSON trace. */
+		void write(std::ostream &stream) const;
+		/**
+		 * Writes all buffered events to a file, replacing its contents.
+		 * @throws std::runtime_error if the file cannot be opened.
+		 */
+		void flush(const std::string &filename);
+
+		size_t getNumEvents() const;
+		size_t getNumDroppedEvents() const;
+
+	protected:
+		class TraceEvent {
+		public:
+			const char *name;
+			/** 'B' for begin, 'E' for end, 'i' for instant events. */
+			char phase;
+			uint64_t timestamp_us;
+			uint64_t slot;
+			int id1, id2;
+		};
+
+		/**
+		 * @param num_reserved Number of events that must fit in addition to this one.
+		 * @return Whether the event has been recorded.
+		 */
+		bool add(const char *name, char phase, uint64_t slot, int id1, int id2, size_t num_reserved);
+
+		int process_id;
+		size_t max_num_events;
+		size_t num_dropped_events = 0;
+		/** Recorded begin events whose end events haven't been recorded yet, each of which reserves capacity for its end event. */
+		size_t num_open_spans = 0;
+		/** Innermost begin events that have been dropped, whose end events are dropped, too. */
+		size_t num_dropped_open_spans = 0;
+		std::vector<TraceEvent> events;
+		std::chrono::steady_clock::time_point start_time;
+	};
+
+	/** Records a begin event upon construction and an end event upon destruction, if a writer is set. */
+	class ScopedTraceEvent {
+	public:
+		ScopedTraceEvent(TraceEventWriter *writer, const char *name, uint64_t slot) : writer(writer), name(name), slot(slot) {
+			if (writer != nullptr)
+				writer->begin(name, slot);
+		}
+
+		~ScopedTraceEvent() {
+			if (writer != nullptr)
+				writer->end(name, slot);
+		}
+
+		ScopedTraceEvent(const ScopedTraceEvent&) = delete;
+		ScopedTraceEvent& operator=(const ScopedTraceEvent&) = delete;
+
+	protected:
+		TraceEventWriter *writer;
+		const char *name;
+		uint64_t slot;
+	};
+}
+
+#endif //TUHH_INTAIRNET_MC_SOTDMA_TRACEEVENTWRITER_HPP
@@ -0,0 +1,84 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <stdexcept>
+#include <string>
+#include "TraceRingBuffer.hpp"
+
+using namespace TUHH_INTAIRNET_MCSOTDMA;
+
+const size_t TraceRingBuffer::NUM_ARGS;
+
+TraceRingBuffer::TraceRingBuffer(size_t capacity) : capacity(capacity) {
+	if (capacity == 0)
+		throw std::invalid_argument("TraceRingBuffer capacity must be positive.");
+}
+
+void TraceRingBuffer::setEnabled(bool value) {
+	if (value && records.empty())
+		records.resize(capacity);
+	this->enabled = value;
+}
+
+size_t TraceRingBuffer::size() const {
+	return num_recorded < capacity ? (size_t) num_recorded : capacity;
+}
+
+size_t TraceRingBuffer::getCapacity() const {
+	return capacity;
+}
+
+uint64_t TraceRingBuffer::getNumRecorded() const {
+	return num_recorded;
+}
+
+const TraceRingBuffer::Record& TraceRingBuffer::at(size_t i) const {
+	if (i >= size())
+		throw std::out_of_range("TraceRingBuffer::at(" + std::to_string(i) + ") for " + std::to_string(size()) + " records.");
+	// once the buffer has wrapped around, the oldest record is the one that is overwritten next
+	size_t oldest_index = num_recorded < capacity ? 0 : next_index;
+	return records[(oldest_index + i) % capacity];
+}
+
+void TraceRingBuffer::clear() {
+	next_index = 0;
+	num_recorded = 0;
+}
+
+void TraceRingBuffer::dump(std::ostream &stream) const {
+	for (size_t i = 0; i < size(); i++) {
+		const Record &record = at(i);
+		stream << "t=" << record.slot << " " << getEventName(record.event);
+		for (size_t j = 0; j < NUM_ARGS; j++)
+			stream << " " << record.args[j];
+		stream << "\n";
+	}
+}
+
+const char* TraceRingBuffer::getEventName(Event event) {
+	switch (event) {
+		case packet_received: return "packet_received";
+		case packet_collision: return "packet_collision";
+		case packet_channel_error: return "packet_channel_error";
+		case broadcast_slot_selected: return "broadcast_slot_selected";
+		case pp_link_establishment_started: return "pp_link_establishment_started";
+		case pp_link_accepted: return "pp_link_accepted";
+		case pp_link_expired: return "pp_link_expired";
+		case third_party_link_reset: return "third_party_link_reset";
+		default: throw std::invalid_argument("TraceRingBuffer::getEventName for invalid event " + std::to_string(event));
+	}
+}
@@ -0,0 +1,117 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef TUHH_INTAIRNET_MC_SOTDMA_TRACERINGBUFFER_HPP
+#define TUHH_INTAIRNET_MC_SOTDMA_TRACERINGBUFFER_HPP
+
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+
+	/**
+	 * Fixed-size buffer of binary trace records that overwrites its oldest records once full.
+	 * Records only hold an event ID, the time slot and a few integer arguments; they are formatted only when dumped.
+	 * Tracing can be switched on and off at runtime, and costs a single branch while it is off.
+	 */
+	class TraceRingBuffer {
+
+		friend class TraceRingBufferTests;
+
+	public:
+		enum Event {
+			/** args: origin ID, destination ID, center frequency */
+			packet_received,
+			/** args: center frequency, number of colliding packets */
+			packet_collision,
+			/** args: center frequency, origin ID */
+			packet_channel_error,
+			/** args: selected slot offset, number of candidate slots */
+			broadcast_slot_selected,
+			/** args: link partner ID, attempt number */
+			pp_link_establishment_started,
+			/** args: link partner ID, slot offset, period */
+			pp_link_accepted,
+			/** args: link partner ID */
+			pp_link_expired,
+			/** args: link initiator ID, link recipient ID */
+			third_party_link_reset,
+			/** not an event, but the number of events */
+			num_events
+		};
+
+		static const size_t NUM_ARGS = 3;
+
+		class Record {
+		public:
+			uint64_t slot;
+			Event event;
+			int64_t args[NUM_ARGS];
+		};
+
+		/**
+		 * @param capacity Number of records that are kept. Memory is only allocated once tracing is enabled.
+		 */
+		explicit TraceRingBuffer(size_t capacity = 4096);
+
+		void setEnabled(bool value);
+		bool isEnabled() const {
+			return enabled;
+		}
+
+		/** Records an event if tracing is enabled. */
+		void record(Event event, uint64_t slot, int64_t arg1 = 0, int64_t arg2 = 0, int64_t arg3 = 0) {
+			if (!enabled)
+				return;
+			Record &record = records[next_index];
+			record.slot = slot;
+			record.event = event;
+			record.args[0] = arg1;
+			record.args[1] = arg2;
+			record.args[2] = arg3;
+			next_index = (next_index + 1) % records.size();
+			num_recorded++;
+		}
+
+		/** @return Number of records currently held, at most the capacity. */
+		size_t size() const;
+		size_t getCapacity() const;
+		/** @return Number of records ever made, including overwritten ones. */
+		uint64_t getNumRecorded() const;
+		/**
+		 * @param i 0 is the oldest record that is still held.
+		 * @throws std::out_of_range if i >= size().
+		 */
+		const Record& at(size_t i) const;
+		void clear();
+
+		/** Writes one line per record, oldest first. */
+		void dump(std::ostream &stream) const;
+
+		static const char* getEventName(Event event);
+
+	protected:
+		size_t capacity;
+		bool enabled = false;
+		std::vector<Record> records;
+		size_t next_index = 0;
+		uint64_t num_recorded = 0;
+	};
+}
+
+#endif //TUHH_INTAIRNET_MC_SOTDMA_TRACERINGBUFFER_HPP
@@ -0,0 +1,87 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <stdexcept>
+#include "WorkerPool.hpp"
+
+using namespace TUHH_INTAIRNET_MCSOTDMA;
+
+WorkerPool::WorkerPool(unsigned int num_threads) {
+	for (unsigned int i = 0; i < num_threads; i++)
+		threads.emplace_back(&WorkerPool::work, this);
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		is_stopping = true;
+	}
+	batch_available.notify_all();
+	for (auto &thread : threads)
+		thread.join();
+}
+
+void WorkerPool::run(size_t num_tasks, const std::function<void(size_t)> &task) {
+	if (num_tasks == 0)
+		return;
+	std::unique_lock<std::mutex> lock(mutex);
+	if (this->task != nullptr)
+		throw std::logic_error("WorkerPool::run while another batch is running.");
+	this->task = &task;
+	this->num_tasks = num_tasks;
+	next_task = 0;
+	num_finished_tasks = 0;
+	errors.assign(num_tasks, nullptr);
+	batch_available.notify_all();
+	workOnBatch(lock);
+	batch_finished.wait(lock, [this] {return num_finished_tasks == this->num_tasks;});
+	this->task = nullptr;
+	for (const auto &error : errors)
+		if (error != nullptr)
+			std::rethrow_exception(error);
+}
+
+unsigned int WorkerPool::getNumThreads() const {
+	return (unsigned int) threads.size();
+}
+
+void WorkerPool::work() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		batch_available.wait(lock, [this] {return is_stopping || (task != nullptr && next_task < num_tasks);});
+		if (is_stopping)
+			return;
+		workOnBatch(lock);
+	}
+}
+
+void WorkerPool::workOnBatch(std::unique_lock<std::mutex> &lock) {
+	while (task != nullptr && next_task < num_tasks) {
+		size_t index = next_task++;
+		const auto *current_task = task;
+		lock.unlock();
+		std::exception_ptr error = nullptr;
+		try {
+			(*current_task)(index);
+		} catch (...) {
+			error = std::current_exception();
+		}
+		lock.lock();
+		errors.at(index) = error;
+		if (++num_finished_tasks == num_tasks)
+			batch_finished.notify_all();
+	}
+}
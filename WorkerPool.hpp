@@ -0,0 +1,78 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef TUHH_INTAIRNET_MC_SOTDMA_WORKERPOOL_HPP
+#define TUHH_INTAIRNET_MC_SOTDMA_WORKERPOOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+
+	/**
+	 * A small, fixed set of threads that runs batches of independent tasks.
+	 * The calling thread works on the batch, too, and run() only returns once every task has finished, s.t. callers see the same results as if the tasks had run sequentially.
+	 */
+	class WorkerPool {
+
+		friend class WorkerPoolTests;
+
+	public:
+		/**
+		 * @param num_threads Number of threads in addition to the calling one.
+		 */
+		explicit WorkerPool(unsigned int num_threads);
+		~WorkerPool();
+
+		/**
+		 * Runs task(0), ..., task(num_tasks - 1) and waits for all of them to finish.
+		 * Tasks mustn't depend on each other, and should write their results to distinct places, indexed by their argument.
+		 * Not reentrant: only one batch may run at a time.
+		 * @param num_tasks
+		 * @param task
+		 * @throws The exception of the task with the smallest index that threw one, once all tasks have finished.
+		 */
+		void run(size_t num_tasks, const std::function<void(size_t)> &task);
+
+		unsigned int getNumThreads() const;
+
+	protected:
+		/** Main loop of each thread. */
+		void work();
+		/**
+		 * Runs tasks of the current batch until none are left.
+		 * @param lock Held on entry and exit, released while a task runs.
+		 */
+		void workOnBatch(std::unique_lock<std::mutex> &lock);
+
+	protected:
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		std::condition_variable batch_available, batch_finished;
+		/** Current batch, or nullptr if there is none. */
+		const std::function<void(size_t)> *task = nullptr;
+		size_t num_tasks = 0, next_task = 0, num_finished_tasks = 0;
+		/** Exceptions thrown by the current batch's tasks, by task index. */
+		std::vector<std::exception_ptr> errors;
+		bool is_stopping = false;
+	};
+}
+
+#endif //TUHH_INTAIRNET_MC_SOTDMA_WORKERPOOL_HPP
@@ -0,0 +1,115 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "../LatencyHistogram.hpp"
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+	class LatencyHistogramTests : public CppUnit::TestFixture {
+	private:
+		LatencyHistogram *histogram;
+
+	public:
+		void setUp() override {
+			histogram = new LatencyHistogram();
+		}
+
+		void tearDown() override {
+			delete histogram;
+		}
+
+		void testBuckets() {
+			// small values are exact
+			for (uint64_t v = 0; v < LatencyHistogram::NUM_SUB_BUCKETS; v++) {
+				CPPUNIT_ASSERT_EQUAL(size_t(v), LatencyHistogram::getBucketIndex(v));
+				CPPUNIT_ASSERT_EQUAL(v, LatencyHistogram::getBucketLowerBound(v));
+				CPPUNIT_ASSERT_EQUAL(v, LatencyHistogram::getBucketUpperBound(v));
+			}
+			// larger values fall into contiguous buckets with bounded relative width
+			for (uint64_t v = LatencyHistogram::NUM_SUB_BUCKETS; v < 100000; v++) {
+				size_t index = LatencyHistogram::getBucketIndex(v);
+				uint64_t lower = LatencyHistogram::getBucketLowerBound(index), upper = LatencyHistogram::getBucketUpperBound(index);
+				CPPUNIT_ASSERT(lower <= v && v <= upper);
+				CPPUNIT_ASSERT((upper - lower + 1) * 8 <= lower);
+				if (v == lower)
+					CPPUNIT_ASSERT_EQUAL(index - 1, LatencyHistogram::getBucketIndex(v - 1));
+			}
+			uint64_t max_value = (uint64_t(1) << LatencyHistogram::MAX_VALUE_BITS) - 1;
+			CPPUNIT_ASSERT_EQUAL(LatencyHistogram::NUM_BUCKETS - 1, LatencyHistogram::getBucketIndex(max_value));
+		}
+
+		void testQuantiles() {
+			CPPUNIT_ASSERT_EQUAL(0.0, histogram->getQuantile(0.5));
+			for (int v = 1; v <= 1000; v++)
+				histogram->record(v);
+			CPPUNIT_ASSERT_EQUAL(uint64_t(1000), histogram->getNumSamples());
+			CPPUNIT_ASSERT_EQUAL(uint64_t(1), histogram->getMin());
+			CPPUNIT_ASSERT_EQUAL(uint64_t(1000), histogram->getMax());
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(500.5, histogram->getMean(), 0.001);
+			// within the bucket resolution of 1/8
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(500.0, histogram->getQuantile(0.5), 500.0 / 8);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(990.0, histogram->getQuantile(0.99), 990.0 / 8);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(999.0, histogram->getQuantile(0.999), 999.0 / 8);
+			CPPUNIT_ASSERT(histogram->getQuantile(1.0) <= 1000.0);
+			CPPUNIT_ASSERT_EQUAL(1.0, histogram->getQuantile(0.0));
+			CPPUNIT_ASSERT_THROW(histogram->getQuantile(1.5), std::invalid_argument);
+		}
+
+		void testTail() {
+			for (int i = 0; i < 999; i++)
+				histogram->record(10);
+			histogram->record(5000);
+			CPPUNIT_ASSERT_EQUAL(10.0, histogram->getQuantile(0.5));
+			CPPUNIT_ASSERT_EQUAL(10.0, histogram->getQuantile(0.99));
+			CPPUNIT_ASSERT_EQUAL(10.0, histogram->getQuantile(0.999));
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(5000.0, histogram->getQuantile(1.0), 5000.0 / 8);
+		}
+
+		void testMerge() {
+			LatencyHistogram other;
+			for (int i = 0; i < 100; i++) {
+				histogram->record(5);
+				other.record(200);
+			}
+			histogram->merge(other);
+			CPPUNIT_ASSERT_EQUAL(uint64_t(200), histogram->getNumSamples());
+			CPPUNIT_ASSERT_EQUAL(uint64_t(5), histogram->getMin());
+			CPPUNIT_ASSERT_EQUAL(uint64_t(200), histogram->getMax());
+			CPPUNIT_ASSERT_EQUAL(5.0, histogram->getQuantile(0.5));
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(200.0, histogram->getQuantile(0.99), 200.0 / 8);
+			histogram->reset();
+			CPPUNIT_ASSERT_EQUAL(uint64_t(0), histogram->getNumSamples());
+		}
+
+		void testClamping() {
+			histogram->record(-3.0);
+			histogram->record(1e15);
+			CPPUNIT_ASSERT_EQUAL(uint64_t(0), histogram->getMin());
+			CPPUNIT_ASSERT_EQUAL((uint64_t(1) << LatencyHistogram::MAX_VALUE_BITS) - 1, histogram->getMax());
+		}
+
+	CPPUNIT_TEST_SUITE(LatencyHistogramTests);
+		CPPUNIT_TEST(testBuckets);
+		CPPUNIT_TEST(testQuantiles);
+		CPPUNIT_TEST(testTail);
+		CPPUNIT_TEST(testMerge);
+		CPPUNIT_TEST(testClamping);
+	CPPUNIT_TEST_SUITE_END();
+	};
+
+}
@@ -51,8 +51,65 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 				
 		}		
 
+		void testFindRanked() {
+			size_t num_proposals = 3;
+			int min_offset = 1;
+			int num_bursts_forward = 1, num_bursts_reverse = 1, period = 1, timeout = 3;
+			// one candidate per channel at a single period should match the unranked search
+			std::vector<LinkProposal> proposals = LinkProposalFinder::findLinkProposals(num_proposals, min_offset, num_bursts_forward, num_bursts_reverse, period, timeout, false, reservation_manager, env->mac_layer);
+			std::vector<LinkProposal> ranked_proposals = LinkProposalFinder::findRankedLinkProposals(num_proposals, 1, min_offset, num_bursts_forward, num_bursts_reverse, period, period, timeout, reservation_manager, env->mac_layer);
+			CPPUNIT_ASSERT_EQUAL(proposals.size(), ranked_proposals.size());
+			for (size_t i = 0; i < proposals.size(); i++) {
+				CPPUNIT_ASSERT_EQUAL(proposals.at(i).center_frequency, ranked_proposals.at(i).center_frequency);
+				CPPUNIT_ASSERT_EQUAL(proposals.at(i).slot_offset, ranked_proposals.at(i).slot_offset);
+				CPPUNIT_ASSERT_EQUAL(proposals.at(i).period, ranked_proposals.at(i).period);
+			}
+			// alternatives across candidates and periods rank behind each channel's best
+			size_t num_ranked_proposals = 7;
+			ranked_proposals = LinkProposalFinder::findRankedLinkProposals(num_ranked_proposals, 2, min_offset, num_bursts_forward, num_bursts_reverse, period, period + 1, timeout, reservation_manager, env->mac_layer);
+			CPPUNIT_ASSERT_EQUAL(num_ranked_proposals, ranked_proposals.size());
+			for (size_t i = 0; i < proposals.size(); i++) {
+				CPPUNIT_ASSERT_EQUAL(proposals.at(i).center_frequency, ranked_proposals.at(i).center_frequency);
+				CPPUNIT_ASSERT_EQUAL(proposals.at(i).slot_offset, ranked_proposals.at(i).slot_offset);
+			}
+			for (size_t i = proposals.size(); i < num_ranked_proposals; i++) {
+				const LinkProposal &better = ranked_proposals.at(i - proposals.size()), &alternative = ranked_proposals.at(i);
+				CPPUNIT_ASSERT_EQUAL(better.center_frequency, alternative.center_frequency);
+				CPPUNIT_ASSERT(better.slot_offset < alternative.slot_offset || (better.slot_offset == alternative.slot_offset && better.period < alternative.period));
+			}
+			CPPUNIT_ASSERT(std::any_of(ranked_proposals.begin(), ranked_proposals.end(), [period](const LinkProposal &proposal) {return proposal.period == period + 1;}));
+		}
+
+		void testFindParallel() {
+			size_t num_proposals = 7, num_candidates_per_channel = 3;
+			int min_offset = 2;
+			int num_bursts_forward = 1, num_bursts_reverse = 1, min_period = 0, max_period = 2, timeout = 3;
+			reservation_manager->getReservationTableByIndex(0)->mark(5, Reservation(partner_id, Reservation::TX));
+			std::vector<LinkProposal> sequential_proposals = LinkProposalFinder::findRankedLinkProposals(num_proposals, num_candidates_per_channel, min_offset, num_bursts_forward, num_bursts_reverse, min_period, max_period, timeout, reservation_manager, env->mac_layer);
+			CPPUNIT_ASSERT(env->mac_layer->getLinkProposalWorkerPool() == nullptr);
+			// search each channel on its own thread
+			env->mac_layer->setParallelLinkProposalSearch(2, 1);
+			CPPUNIT_ASSERT(env->mac_layer->getLinkProposalWorkerPool() != nullptr);
+			for (size_t n = 0; n < 10; n++) {
+				std::vector<LinkProposal> parallel_proposals = LinkProposalFinder::findRankedLinkProposals(num_proposals, num_candidates_per_channel, min_offset, num_bursts_forward, num_bursts_reverse, min_period, max_period, timeout, reservation_manager, env->mac_layer);
+				CPPUNIT_ASSERT_EQUAL(sequential_proposals.size(), parallel_proposals.size());
+				for (size_t i = 0; i < sequential_proposals.size(); i++) {
+					CPPUNIT_ASSERT_EQUAL(sequential_proposals.at(i).center_frequency, parallel_proposals.at(i).center_frequency);
+					CPPUNIT_ASSERT_EQUAL(sequential_proposals.at(i).slot_offset, parallel_proposals.at(i).slot_offset);
+					CPPUNIT_ASSERT_EQUAL(sequential_proposals.at(i).period, parallel_proposals.at(i).period);
+				}
+			}
+			// below the threshold, the search is sequential again
+			env->mac_layer->setParallelLinkProposalSearch(2, 1000);
+			CPPUNIT_ASSERT_EQUAL(sequential_proposals.size(), LinkProposalFinder::findRankedLinkProposals(num_proposals, num_candidates_per_channel, min_offset, num_bursts_forward, num_bursts_reverse, min_period, max_period, timeout, reservation_manager, env->mac_layer).size());
+			env->mac_layer->setParallelLinkProposalSearch(0);
+			CPPUNIT_ASSERT(env->mac_layer->getLinkProposalWorkerPool() == nullptr);
+		}
+
 	CPPUNIT_TEST_SUITE(LinkProposalFinderTests);
 			CPPUNIT_TEST(testFind);			
+			CPPUNIT_TEST(testFindRanked);
+			CPPUNIT_TEST(testFindParallel);
 		CPPUNIT_TEST_SUITE_END();
 	};
 
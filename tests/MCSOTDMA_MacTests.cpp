@@ -19,6 +19,7 @@
 #include "../MCSOTDMA_Mac.hpp"
 #include "MockLayers.hpp"
 #include "../LinkManager.hpp"
+#include "../SHLinkManager.hpp"
 
 
 namespace TUHH_INTAIRNET_MCSOTDMA {
@@ -114,18 +115,124 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			CPPUNIT_ASSERT_EQUAL(size_t(0), (size_t) mac->stat_num_packets_rcvd.get());
 		}
 
+		void testReceptionBuffersAreReused() {
+			auto *packet1 = new L2Packet(), *packet2 = new L2Packet();
+			packet1->addMessage(new L2HeaderSH(MacId(10)), nullptr);
+			packet2->addMessage(new L2HeaderSH(MacId(11)), nullptr);
+			mac->receiveFromLower(packet1, env->sh_frequency);
+			mac->receiveFromLower(packet2, env->sh_frequency);
+			CPPUNIT_ASSERT_EQUAL(size_t(1), mac->reception_buffers.size());
+			CPPUNIT_ASSERT_EQUAL(size_t(2), mac->reception_buffers.at(0).size());
+			mac->onSlotEnd();
+			// emptied but not released
+			CPPUNIT_ASSERT_EQUAL(size_t(1), mac->reception_buffers.size());
+			CPPUNIT_ASSERT_EQUAL(size_t(0), mac->reception_buffers.at(0).size());
+			CPPUNIT_ASSERT_GREATEREQUAL(size_t(2), mac->reception_buffers.at(0).capacity());
+			// buffers remain sorted by frequency
+			auto *packet3 = new L2Packet();
+			packet3->addMessage(new L2HeaderSH(MacId(12)), nullptr);
+			mac->receiveFromLower(packet3, env->p2p_freq_1);
+			CPPUNIT_ASSERT_EQUAL(size_t(2), mac->reception_buffers.size());
+			CPPUNIT_ASSERT_EQUAL(env->p2p_freq_1, mac->reception_buffer_frequencies.at(0));
+			CPPUNIT_ASSERT_EQUAL(env->sh_frequency, mac->reception_buffer_frequencies.at(1));
+			CPPUNIT_ASSERT_EQUAL(size_t(1), mac->reception_buffers.at(0).size());
+			CPPUNIT_ASSERT_EQUAL(size_t(0), mac->reception_buffers.at(1).size());
+			mac->reception_buffers.at(0).clear();
+			delete packet3;
+		}
+
+		void testStatisticRegistry() {
+			const auto &registry = mac->getStatisticRegistry();
+			CPPUNIT_ASSERT_EQUAL(mac->statistics.size(), registry.size());
+			CPPUNIT_ASSERT_EQUAL(size_t(0), registry.getNumDirty());
+			mac->statisticReportBroadcastSent();
+			mac->statisticReportBroadcastSent();
+			CPPUNIT_ASSERT_EQUAL(size_t(1), registry.getNumDirty());
+		}
+
+		void testLatencyHistograms() {
+			for (unsigned int delay = 1; delay <= 100; delay++)
+				mac->statisticReportBroadcastMacDelay(delay);
+			mac->statisticReportPPLinkEstablishmentTime(42);
+			CPPUNIT_ASSERT_EQUAL(uint64_t(100), mac->getBroadcastMacDelayHistogram().getNumSamples());
+			CPPUNIT_ASSERT_EQUAL(uint64_t(100), mac->getBroadcastMacDelayHistogram().getMax());
+			CPPUNIT_ASSERT_EQUAL(uint64_t(0), mac->getUnicastMacDelayHistogram().getNumSamples());
+			CPPUNIT_ASSERT_EQUAL(42.0, mac->getPPLinkEstablishmentTimeHistogram().getQuantile(0.5));
+		}
+
+		void testTraceLinkMilestone() {
+			// disabled sinks record nothing
+			mac->traceLinkMilestone("PPLinkManager::acceptLink", mac->getMacId(), partner_id, TraceRingBuffer::pp_link_accepted, partner_id.getId(), 5, 20);
+			CPPUNIT_ASSERT_EQUAL(size_t(0), mac->getTraceRingBuffer().size());
+			mac->setTracingEnabled(true);
+			mac->traceLinkMilestone("PPLinkManager::acceptLink", mac->getMacId(), partner_id, TraceRingBuffer::pp_link_accepted, partner_id.getId(), 5, 20);
+			CPPUNIT_ASSERT_EQUAL(size_t(1), mac->getTraceRingBuffer().size());
+			const auto &record = mac->getTraceRingBuffer().at(0);
+			CPPUNIT_ASSERT_EQUAL(TraceRingBuffer::pp_link_accepted, record.event);
+			CPPUNIT_ASSERT_EQUAL(int64_t(partner_id.getId()), record.args[0]);
+			CPPUNIT_ASSERT_EQUAL(int64_t(5), record.args[1]);
+			CPPUNIT_ASSERT_EQUAL(int64_t(20), record.args[2]);
+		}
+
 		void testDMEPacketChannelSensing() {
 			CPPUNIT_ASSERT_THROW(mac->getChannelSensingObservation(), std::runtime_error);
 			mac->setLearnDMEActivity(true);
 			CPPUNIT_ASSERT_NO_THROW(mac->getChannelSensingObservation());			
 		}		
 
+		void testCoalesceOutgoingNotifications() {
+			mac->setCoalesceOutgoingNotifications(true);
+			MacId other_id = MacId(43);
+			LinkManager *pp = mac->getLinkManager(partner_id), *other_pp = mac->getLinkManager(other_id);
+			auto *sh = (SHLinkManager*) mac->getLinkManager(SYMBOLIC_LINK_ID_BROADCAST);
+			mac->notifyOutgoing(10, other_id);
+			for (size_t i = 0; i < 3; i++) {
+				mac->notifyOutgoing(100, partner_id);
+				mac->notifyOutgoing(10, SYMBOLIC_LINK_ID_BROADCAST);
+			}
+			// nothing happens until the notifications are processed
+			CPPUNIT_ASSERT_EQUAL(LinkManager::link_not_established, pp->getLinkStatus());
+			CPPUNIT_ASSERT_EQUAL(false, sh->isNextBroadcastScheduled());
+			CPPUNIT_ASSERT_EQUAL(size_t(3), mac->outgoing_notifications.size());
+			CPPUNIT_ASSERT_EQUAL(partner_id, mac->outgoing_notifications.at(1).first);
+			CPPUNIT_ASSERT_EQUAL((unsigned long) 300, mac->outgoing_notifications.at(1).second);
+			CPPUNIT_ASSERT_EQUAL((unsigned long) 30, mac->outgoing_notifications.at(2).second);
+			// which happens once, before this slot's transmissions
+			mac->update(1);
+			mac->execute();
+			CPPUNIT_ASSERT_EQUAL(true, mac->outgoing_notifications.empty());
+			CPPUNIT_ASSERT_EQUAL(LinkManager::awaiting_request_generation, pp->getLinkStatus());
+			CPPUNIT_ASSERT_EQUAL(LinkManager::awaiting_request_generation, other_pp->getLinkStatus());
+			CPPUNIT_ASSERT_EQUAL(true, sh->isNextBroadcastScheduled());
+			// the larger backlog was processed first, although it was notified last
+			CPPUNIT_ASSERT_EQUAL(size_t(2), sh->link_requests.size());
+			CPPUNIT_ASSERT_EQUAL(partner_id, sh->link_requests.front().first);
+			// the summed bits feed the traffic estimates once per slot
+			mac->onSlotEnd();
+			CPPUNIT_ASSERT_EQUAL(300.0, pp->getOutgoingTrafficEstimate());
+			CPPUNIT_ASSERT_EQUAL(30.0, sh->getOutgoingTrafficEstimate());
+			mac->update(1);
+			mac->onSlotEnd();
+			CPPUNIT_ASSERT_EQUAL(150.0, pp->getOutgoingTrafficEstimate());
+			CPPUNIT_ASSERT_EQUAL(15.0, sh->getOutgoingTrafficEstimate());
+			// disabling processes pending notifications right away
+			mac->notifyOutgoing(100, partner_id);
+			CPPUNIT_ASSERT_EQUAL(size_t(1), mac->outgoing_notifications.size());
+			mac->setCoalesceOutgoingNotifications(false);
+			CPPUNIT_ASSERT_EQUAL(true, mac->outgoing_notifications.empty());
+		}
+
 		CPPUNIT_TEST_SUITE(MCSOTDMA_MacTests);
 			CPPUNIT_TEST(testPositions);
 			CPPUNIT_TEST(testCollision);
 			CPPUNIT_TEST(testChannelError);			
 			CPPUNIT_TEST(testCollisionAndChannelError);			
-			CPPUNIT_TEST(testDMEPacketChannelSensing);						
+			CPPUNIT_TEST(testDMEPacketChannelSensing);
+			CPPUNIT_TEST(testReceptionBuffersAreReused);
+			CPPUNIT_TEST(testStatisticRegistry);
+			CPPUNIT_TEST(testLatencyHistograms);
+			CPPUNIT_TEST(testTraceLinkMilestone);						
+			CPPUNIT_TEST(testCoalesceOutgoingNotifications);
 		CPPUNIT_TEST_SUITE_END();
 	};
 
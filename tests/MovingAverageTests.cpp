@@ -52,8 +52,57 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			CPPUNIT_ASSERT_EQUAL(sum / (size), avg->get());
 		}
 
+		void testRingBuffer() {
+			MovingAverage window(3);
+			CPPUNIT_ASSERT_EQUAL(false, window.hasBeenUpdated());
+			for (unsigned long value = 1; value <= 7; value++)
+				window.put(value);
+			CPPUNIT_ASSERT_EQUAL(true, window.hasBeenUpdated());
+			CPPUNIT_ASSERT_EQUAL(true, window.hasReachedNumValues());
+			CPPUNIT_ASSERT_EQUAL(6.0, window.get());
+			CPPUNIT_ASSERT_EQUAL(18ULL, window.sum);
+			// values in order of insertion
+			CPPUNIT_ASSERT_EQUAL(5ULL, window.getValue(0));
+			CPPUNIT_ASSERT_EQUAL(7ULL, window.getValue(2));
+			window.reset();
+			CPPUNIT_ASSERT_EQUAL(false, window.hasBeenUpdated());
+		}
+
+		void testResizeKeepsOldestValues() {
+			MovingAverage window(3);
+			for (unsigned long value = 1; value <= 5; value++)
+				window.put(value);
+			// window is now 3, 4, 5
+			MovingAverage smaller(window, 2);
+			CPPUNIT_ASSERT_EQUAL(true, smaller.hasReachedNumValues());
+			CPPUNIT_ASSERT_EQUAL(3.5, smaller.get());
+			MovingAverage larger(window, 5);
+			CPPUNIT_ASSERT_EQUAL(false, larger.hasReachedNumValues());
+			CPPUNIT_ASSERT_EQUAL(4.0, larger.get());
+			larger.put(6);
+			larger.put(7);
+			CPPUNIT_ASSERT_EQUAL(true, larger.hasReachedNumValues());
+			CPPUNIT_ASSERT_EQUAL(5.0, larger.get());
+		}
+
+		void testExponentialWeight() {
+			MovingAverage window(4);
+			CPPUNIT_ASSERT_THROW(window.setExponentialWeight(0.0), std::invalid_argument);
+			window.setExponentialWeight(0.5);
+			window.put(8);
+			CPPUNIT_ASSERT_EQUAL(8.0, window.get());
+			window.put(4);
+			CPPUNIT_ASSERT_EQUAL(6.0, window.get());
+			window.put(0);
+			CPPUNIT_ASSERT_EQUAL(3.0, window.get());
+			CPPUNIT_ASSERT_EQUAL(false, window.hasReachedNumValues());
+		}
+
 	CPPUNIT_TEST_SUITE(MovingAverageTests);
 			CPPUNIT_TEST(testAvg);
+			CPPUNIT_TEST(testRingBuffer);
+			CPPUNIT_TEST(testResizeKeepsOldestValues);
+			CPPUNIT_TEST(testExponentialWeight);
 		CPPUNIT_TEST_SUITE_END();
 	};
 }
\ No newline at end of file
@@ -64,7 +64,7 @@ public:
 		CPPUNIT_ASSERT_EQUAL(true, sh->isNextBroadcastScheduled());
 		CPPUNIT_ASSERT_EQUAL(false, sh->link_requests.empty());
 		CPPUNIT_ASSERT_EQUAL(size_t(1), sh->link_requests.size());
-		CPPUNIT_ASSERT_EQUAL(partner_id, sh->link_requests.at(0).first);
+		CPPUNIT_ASSERT_EQUAL(partner_id, sh->link_requests.front().first);
 	}
 
 	/** Tests that when there's no saved, advertised link, the SH initiates a two-way handshake. */
@@ -326,7 +326,7 @@ public:
 		CPPUNIT_ASSERT_EQUAL(size_t(1), (size_t) mac->stat_num_pp_link_requests_accepted.get());
 		// and a link reply should be pending
 		CPPUNIT_ASSERT_EQUAL(size_t(1), sh->link_replies.size());
-		const L2HeaderSH::LinkReply &reply = sh->link_replies.at(0);
+		const L2HeaderSH::LinkReply &reply = sh->link_replies.front().second;
 		CPPUNIT_ASSERT_EQUAL(2, reply.proposed_link.slot_offset);
 	}
 
@@ -940,6 +940,41 @@ public:
 		}			
 	}
 
+	void testReservationMapNextReservations() {
+		ReservationTable table = ReservationTable(planning_horizon);
+		ReservationMap map;
+		table.mark(10, Reservation(partner_id, Reservation::TX));
+		table.mark(20, Reservation(partner_id, Reservation::RX));
+		table.mark(30, Reservation(partner_id, Reservation::TX));
+		table.mark(40, Reservation(partner_id, Reservation::RX));
+		// add out of order
+		for (int slot : {30, 10, 40, 20})
+			map.add_scheduled_resource(&table, slot);
+		CPPUNIT_ASSERT_EQUAL(10, map.getNextTxReservation().second);
+		CPPUNIT_ASSERT_EQUAL(20, map.getNextRxReservation().second);
+		CPPUNIT_ASSERT(map.getNextTxReservation().first == &table);
+		for (size_t t = 0; t < 11; t++) {
+			table.update(1);
+			map.onSlotStart();
+		}
+		// the first transmission has passed and should've been dropped
+		CPPUNIT_ASSERT_EQUAL(size_t(3), map.size_scheduled());
+		CPPUNIT_ASSERT_EQUAL(30 - 11, map.getNextTxReservation().second);
+		CPPUNIT_ASSERT_EQUAL(20 - 11, map.getNextRxReservation().second);
+		// an unscheduled transmission shouldn't be found, but once it is scheduled again
+		table.mark(30 - 11, Reservation());
+		CPPUNIT_ASSERT(map.getNextTxReservation().first == nullptr);
+		table.mark(30 - 11, Reservation(partner_id, Reservation::TX));
+		CPPUNIT_ASSERT_EQUAL(30 - 11, map.getNextTxReservation().second);
+		// once everything has passed, nothing is kept
+		for (size_t t = 0; t < 30; t++) {
+			table.update(1);
+			map.onSlotStart();
+		}
+		CPPUNIT_ASSERT_EQUAL(size_t(0), map.size());
+		CPPUNIT_ASSERT(map.getNextRxReservation().first == nullptr);
+	}
+
 	CPPUNIT_TEST_SUITE(PPLinkManagerTests);
 		CPPUNIT_TEST(testGet);		
 		CPPUNIT_TEST(testAskSHToSendLinkRequest);
@@ -970,6 +1005,7 @@ public:
 		CPPUNIT_TEST(testPPLinkEstablishmentTime);		
 		CPPUNIT_TEST(testManyPPLinkEstablishmentTimes);
 		CPPUNIT_TEST(testManyPPLinkEstablishmentTimesStartLate);				
+		CPPUNIT_TEST(testReservationMapNextReservations);
 		
 	CPPUNIT_TEST_SUITE_END();
 };
@@ -18,6 +18,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include "../ReservationTable.hpp"
 #include "../ReservationManager.hpp"
+#include "../SlotCalculator.hpp"
 
 namespace TUHH_INTAIRNET_MCSOTDMA {
 	class ReservationManagerTests : public CppUnit::TestFixture {
@@ -275,6 +276,115 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			CPPUNIT_ASSERT_EQUAL(true, reservations.at(1).first.isTx());
 		}
 
+		void testAreLinksValid() {
+			auto *tx_table = new ReservationTable(planning_horizon), *rx_table = new ReservationTable(planning_horizon);
+			reservation_manager->setTransmitterReservationTable(tx_table);
+			reservation_manager->addReceiverReservationTable(rx_table);
+			reservation_manager->addFrequencyChannel(false, 1000, 500);
+			reservation_manager->addFrequencyChannel(true, 2000, 500);
+			reservation_manager->addFrequencyChannel(true, 3000, 500);
+			// block some slots on the first channel, which also blocks the hardware for the second one
+			reservation_manager->getReservationTableByIndex(0)->mark(20, Reservation(MacId(42), Reservation::RX));
+			reservation_manager->getReservationTableByIndex(1)->mark(45, Reservation(MacId(42), Reservation::TX));
+			std::vector<LinkProposal> links;
+			for (uint64_t f : {2000, 3000, 2000})
+				for (int start = 1; start < 60; start += 3) {
+					LinkProposal link;
+					link.center_frequency = f;
+					link.slot_offset = start;
+					link.period = start % 3;
+					links.push_back(link);
+				}
+			int timeout = 5;
+			for (bool is_link_initiator : {true, false}) {
+				auto are_valid = reservation_manager->areLinksValid(links, timeout, is_link_initiator);
+				CPPUNIT_ASSERT_EQUAL(links.size(), are_valid.size());
+				size_t num_valid = 0;
+				for (size_t i = 0; i < links.size(); i++) {
+					const auto &link = links.at(i);
+					const ReservationTable *table = reservation_manager->getReservationTable(reservation_manager->getFreqChannelByCenterFreq(link.center_frequency));
+					bool expected = table->isLinkValid(link.slot_offset, link.period, link.num_tx_initiator, link.num_tx_recipient, timeout, is_link_initiator);
+					CPPUNIT_ASSERT_EQUAL(expected, (bool) are_valid.at(i));
+					num_valid += are_valid.at(i) ? 1 : 0;
+				}
+				CPPUNIT_ASSERT_GREATER(size_t(0), num_valid);
+				CPPUNIT_ASSERT_LESS(links.size(), num_valid);
+			}
+			delete tx_table;
+			delete rx_table;
+		}
+
+		void testProposalValidityCache() {
+			auto *tx_table = new ReservationTable(planning_horizon), *rx_table = new ReservationTable(planning_horizon);
+			reservation_manager->setTransmitterReservationTable(tx_table);
+			reservation_manager->addReceiverReservationTable(rx_table);
+			reservation_manager->addFrequencyChannel(false, 1000, 500);
+			reservation_manager->addFrequencyChannel(true, 2000, 500);
+			ReservationTable *table = reservation_manager->getReservationTableByIndex(0);
+			LinkProposal link;
+			link.center_frequency = 2000;
+			link.slot_offset = 10;
+			link.period = 1;
+			int timeout = 5;
+			const auto tx_rx_slots = SlotCalculator::calculateAlternatingBursts(link.slot_offset, link.num_tx_initiator, link.num_tx_recipient, link.period, timeout);
+			const auto &cache = reservation_manager->proposal_validity_cache;
+			// validities are cached
+			CPPUNIT_ASSERT_EQUAL(true, (bool) reservation_manager->areLinksValid({link}, timeout, true).at(0));
+			CPPUNIT_ASSERT_EQUAL(size_t(1), cache.size());
+			CPPUNIT_ASSERT_EQUAL(true, (bool) reservation_manager->areLinksValid({link}, timeout, true).at(0));
+			CPPUNIT_ASSERT_EQUAL(size_t(1), cache.size());
+			// reservations in other time slots don't matter
+			table->mark(link.slot_offset + 1, Reservation(MacId(42), Reservation::RX));
+			tx_table->lock(link.slot_offset + 1, MacId(42));
+			CPPUNIT_ASSERT_EQUAL(size_t(1), cache.size());
+			// but those in the link's time slots do
+			table->mark(tx_rx_slots.second.at(1), Reservation(MacId(42), Reservation::TX));
+			CPPUNIT_ASSERT_EQUAL(size_t(0), cache.size());
+			CPPUNIT_ASSERT_EQUAL(false, (bool) reservation_manager->areLinksValid({link}, timeout, true).at(0));
+			CPPUNIT_ASSERT_EQUAL(size_t(1), cache.size());
+			// including those made directly on the hardware tables
+			table->mark(tx_rx_slots.second.at(1), Reservation(SYMBOLIC_ID_UNSET, Reservation::IDLE));
+			CPPUNIT_ASSERT_EQUAL(true, (bool) reservation_manager->areLinksValid({link}, timeout, true).at(0));
+			rx_table->lock(tx_rx_slots.second.at(0), MacId(42));
+			CPPUNIT_ASSERT_EQUAL(size_t(0), cache.size());
+			CPPUNIT_ASSERT_EQUAL(false, (bool) reservation_manager->areLinksValid({link}, timeout, true).at(0));
+			CPPUNIT_ASSERT_EQUAL(size_t(1), cache.size());
+			// entries remain as time passes, with the link now starting earlier
+			rx_table->unlock(tx_rx_slots.second.at(0), MacId(42));
+			CPPUNIT_ASSERT_EQUAL(true, (bool) reservation_manager->areLinksValid({link}, timeout, true).at(0));
+			size_t num_slots = 3;
+			reservation_manager->update(num_slots);
+			tx_table->update(num_slots);
+			rx_table->update(num_slots);
+			CPPUNIT_ASSERT_EQUAL(size_t(1), cache.size());
+			LinkProposal later_link = link;
+			later_link.slot_offset -= num_slots;
+			bool is_valid = false;
+			CPPUNIT_ASSERT_EQUAL(true, cache.find(table, later_link, timeout, true, is_valid));
+			CPPUNIT_ASSERT_EQUAL(true, is_valid);
+			CPPUNIT_ASSERT_EQUAL(false, cache.find(table, link, timeout, true, is_valid));
+			// and are dropped once the link's start has passed
+			reservation_manager->update(later_link.slot_offset + 1);
+			tx_table->update(later_link.slot_offset + 1);
+			rx_table->update(later_link.slot_offset + 1);
+			CPPUNIT_ASSERT_EQUAL(size_t(0), cache.size());
+			// other listeners don't replace the manager's
+			size_t num_changes = 0;
+			auto token = rx_table->addChangeListener([&num_changes](const ReservationTable*, int) {
+				num_changes++;
+			});
+			CPPUNIT_ASSERT_EQUAL(true, (bool) reservation_manager->areLinksValid({link}, timeout, true).at(0));
+			rx_table->lock(tx_rx_slots.second.at(0), MacId(42));
+			CPPUNIT_ASSERT_EQUAL(size_t(1), num_changes);
+			CPPUNIT_ASSERT_EQUAL(size_t(0), cache.size());
+			token.reset();
+			rx_table->unlock(tx_rx_slots.second.at(0), MacId(42));
+			CPPUNIT_ASSERT_EQUAL(size_t(1), num_changes);
+			// the PHY may destroy its tables before or after the manager
+			delete tx_table;
+			delete rx_table;
+		}
+
 	CPPUNIT_TEST_SUITE(ReservationManagerTests);
 			CPPUNIT_TEST(testAddFreqChannel);
 			CPPUNIT_TEST(testUpdate);
@@ -284,6 +394,8 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			CPPUNIT_TEST(testGetTxReservations);
 			CPPUNIT_TEST(testUpdateTables);
 			CPPUNIT_TEST(testCollectCurrentReservations);
+			CPPUNIT_TEST(testAreLinksValid);
+			CPPUNIT_TEST(testProposalValidityCache);
 		CPPUNIT_TEST_SUITE_END();
 	};
 }
\ No newline at end of file
@@ -572,6 +572,71 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		// 	CPPUNIT_ASSERT_EQUAL(uint32_t(4), start_slot);
 		// }
 
+		void testCountTxReservations() {
+			CPPUNIT_ASSERT_EQUAL(0u, table->countTxReservations(-int32_t(planning_horizon), 2*planning_horizon + 1));
+			table->mark(1, Reservation(MacId(1), Reservation::TX));
+			table->mark(3, Reservation(MacId(1), Reservation::RX));
+			table->mark(5, Reservation(MacId(1), Reservation::TX));
+			table->mark(planning_horizon, Reservation(MacId(1), Reservation::TX));
+			CPPUNIT_ASSERT_EQUAL(2u, table->countTxReservations(0, 6));
+			CPPUNIT_ASSERT_EQUAL(1u, table->countTxReservations(2, 4));
+			CPPUNIT_ASSERT_EQUAL(3u, table->countTxReservations(0, planning_horizon + 1));
+			CPPUNIT_ASSERT_THROW(table->countTxReservations(0, planning_horizon + 2), std::invalid_argument);
+			// un-marking clears the bit
+			table->mark(5, Reservation(SYMBOLIC_ID_UNSET, Reservation::IDLE));
+			CPPUNIT_ASSERT_EQUAL(1u, table->countTxReservations(0, 6));
+			// the bitmap should move along with time, also when wrapping around many times
+			for (size_t t = 0; t < 10*planning_horizon; t++) {
+				table->update(1);
+				unsigned int num_txs = 0;
+				for (int offset = -int32_t(planning_horizon); offset <= int32_t(planning_horizon); offset++)
+					if (table->getReservation(offset).isAnyTx())
+						num_txs++;
+				CPPUNIT_ASSERT_EQUAL(num_txs, table->countTxReservations(-int32_t(planning_horizon), 2*planning_horizon + 1));
+				if (t % 7 == 0)
+					table->mark(planning_horizon - 1, Reservation(MacId(1), Reservation::TX));
+			}
+		}
+
+		void testFindPPCandidatesForPeriods() {
+			ReservationTable long_table = ReservationTable(512), long_table_tx = ReservationTable(512), long_table_rx = ReservationTable(512);
+			long_table.linkTransmitterReservationTable(&long_table_tx);
+			long_table.linkReceiverReservationTable(&long_table_rx);
+			for (int slot : {3, 4, 17, 45, 90})
+				long_table.mark(slot, Reservation(MacId(42), Reservation::TX));
+			long_table_rx.mark(25, Reservation(MacId(43), Reservation::RX));
+			unsigned int min_offset = 2, num_candidates = 4;
+			int num_bursts_forward = 2, num_bursts_reverse = 1, min_period = 0, max_period = 5, timeout = 3;
+			auto candidates = long_table.findPPCandidates(num_candidates, min_offset, num_bursts_forward, num_bursts_reverse, min_period, max_period, timeout);
+			CPPUNIT_ASSERT_EQUAL(size_t(max_period - min_period + 1), candidates.size());
+			// each period should find the same as a separate search
+			for (int period = min_period; period <= max_period; period++)
+				CPPUNIT_ASSERT(long_table.findPPCandidates(num_candidates, min_offset, num_bursts_forward, num_bursts_reverse, period, timeout) == candidates.at(period - min_period));
+			CPPUNIT_ASSERT_EQUAL(size_t(num_candidates), candidates.at(0).size());
+			// long periods exceed the planning horizon
+			CPPUNIT_ASSERT_EQUAL(true, candidates.at(max_period - min_period).empty());
+		}
+
+		void testGeneration() {
+			uint64_t generation = table->getGeneration();
+			// passing time doesn't change reservations
+			table->update(1);
+			CPPUNIT_ASSERT_EQUAL(generation, table->getGeneration());
+			table->mark(3, Reservation(MacId(1), Reservation::TX));
+			CPPUNIT_ASSERT_GREATER(generation, table->getGeneration());
+			// neither does marking what's already there
+			generation = table->getGeneration();
+			table->mark(3, Reservation(MacId(1), Reservation::TX));
+			CPPUNIT_ASSERT_EQUAL(generation, table->getGeneration());
+			table->lock(5, MacId(1));
+			CPPUNIT_ASSERT_GREATER(generation, table->getGeneration());
+			generation = table->getGeneration();
+			table->unlock(5, MacId(1));
+			CPPUNIT_ASSERT_GREATER(generation, table->getGeneration());
+			// the linked transmitter table has changed, too
+			CPPUNIT_ASSERT_GREATER(uint64_t(0), table_tx->getGeneration());
+		}
+
 	CPPUNIT_TEST_SUITE(ReservationTableTests);
 			CPPUNIT_TEST(testConstructor);
 			CPPUNIT_TEST(testPlanningHorizon);
@@ -594,6 +659,9 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			CPPUNIT_TEST(testLinkedTXTable);
 			CPPUNIT_TEST(testLinkedRXTables);			
 			CPPUNIT_TEST(testDefaultReservation);
+			CPPUNIT_TEST(testCountTxReservations);
+			CPPUNIT_TEST(testFindPPCandidatesForPeriods);
+			CPPUNIT_TEST(testGeneration);
 			// CPPUNIT_TEST(testFindEarliestIdleSlots);
 		CPPUNIT_TEST_SUITE_END();
 	};
@@ -50,11 +50,41 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			CPPUNIT_ASSERT(chosen_slot >= uint32_t(1) && chosen_slot <= link_manager->MIN_CANDIDATES);
 		}
 
+		void testBroadcastSlotSelectionSamplesCandidates() {
+			mac->setTracingEnabled(true);
+			// make slots 2 and 3 unusable, s.t. the candidates are 1, 4 and 5
+			link_manager->current_reservation_table->mark(2, Reservation(partner_id, Reservation::BUSY));
+			link_manager->current_reservation_table->mark(3, Reservation(partner_id, Reservation::BUSY));
+			for (size_t i = 0; i < 50; i++) {
+				unsigned int chosen_slot = link_manager->broadcastSlotSelection(1);
+				CPPUNIT_ASSERT(chosen_slot == 1 || chosen_slot == 4 || chosen_slot == 5);
+				// the number of scanned candidates is traced
+				const auto &record = mac->getTraceRingBuffer().at(mac->getTraceRingBuffer().size() - 1);
+				CPPUNIT_ASSERT_EQUAL(TraceRingBuffer::broadcast_slot_selected, record.event);
+				CPPUNIT_ASSERT_EQUAL(int64_t(chosen_slot), record.args[0]);
+				CPPUNIT_ASSERT_EQUAL(int64_t(link_manager->MIN_CANDIDATES), record.args[1]);
+			}
+		}
+
 		void testScheduleBroadcastSlot() {
 			link_manager->scheduleBroadcastSlot();
 			CPPUNIT_ASSERT_GREATEREQUAL(uint32_t(1), link_manager->next_broadcast_slot);
 		}
 
+		/** Tests that no broadcast is scheduled if the duty cycle forecast admits no slot within the planning horizon. */
+		void testScheduleBroadcastSlotWithoutConformantForecast() {
+			mac->setUseDutyCycleForecast(true);
+			// at most 10 transmissions within 100 slots, and every tenth slot is already used
+			mac->setDutyCycle(100, 0.1, 4);
+			ReservationTable *tx_table = mac->getReservationManager()->getTxTable();
+			for (int t = 10; t <= (int) planning_horizon; t += 10)
+				tx_table->mark(t, Reservation(partner_id, Reservation::TX));
+			CPPUNIT_ASSERT_EQUAL(-1, mac->getDutyCycle().getEarliestConformantOffset(tx_table, 1));
+			// no broadcast may be scheduled that would exceed the duty cycle
+			CPPUNIT_ASSERT_THROW(link_manager->scheduleBroadcastSlot(), no_duty_cycle_budget_left_error);
+			CPPUNIT_ASSERT_EQUAL(false, link_manager->next_broadcast_scheduled);
+		}
+
 		void testBroadcast() {
 			link_manager->notifyOutgoing(1);
 			env->rlc_layer->should_there_be_more_broadcast_data = true;
@@ -285,6 +315,29 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			k = new_k;
 		}
 
+		void testCandidateSlotTable() {
+			double target_collision_prob = .626;
+			link_manager->setTargetCollisionProb(target_collision_prob);
+			const auto &table = mac->getBroadcastCandidateSlotTable(100);
+			CPPUNIT_ASSERT_EQUAL(size_t(101), table.size());
+			for (size_t m = 0; m < table.size(); m++) {
+				unsigned int expected_k = std::min(link_manager->MAX_CANDIDATES, std::max(link_manager->MIN_CANDIDATES, (uint) std::ceil(1.0 / (1.0 - std::pow(1.0 - target_collision_prob, 1.0 / m)))));
+				CPPUNIT_ASSERT_EQUAL(expected_k, table.at(m));
+			}
+			// changing the bounds rebuilds the table, which stops once the maximum is reached
+			link_manager->setMaxNumCandidateSlots(10);
+			const auto &bounded_table = link_manager->getCandidateSlotTable(100);
+			CPPUNIT_ASSERT_LESS(size_t(101), bounded_table.size());
+			CPPUNIT_ASSERT_EQUAL(10u, bounded_table.back());
+			for (size_t i = 0; i < 50; i++)
+				mac->reportNeighborActivity(MacId(i));
+			CPPUNIT_ASSERT_EQUAL(10u, link_manager->getNumCandidateSlots(target_collision_prob, link_manager->MIN_CANDIDATES, link_manager->MAX_CANDIDATES));
+			// other parameters than the configured ones are still honored
+			link_manager->setMaxNumCandidateSlots(10000);
+			unsigned int expected_k = std::ceil(1.0 / (1.0 - std::pow(1.0 - 0.05, 1.0 / 50.0)));
+			CPPUNIT_ASSERT_EQUAL(expected_k, link_manager->getNumCandidateSlots(0.05, link_manager->MIN_CANDIDATES, link_manager->MAX_CANDIDATES));
+		}
+
 		/** During simulations, a maximum no. of candidate slots was observed, which didn't make much sense. */
 		void testNoCandidateSlotsForParticularValues() {
 			size_t num_neighbors = 60;
@@ -338,6 +391,27 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			delete header;
 		}
 
+		/** Tests that link requests destined to us are checked against the resources locked by third-party link requests of the same header, regardless of their order. */
+		void testOwnLinkRequestRespectsThirdPartyLocks() {
+			mac->setConsiderDutyCycle(false);
+			link_manager->next_broadcast_scheduled = true;
+			link_manager->next_broadcast_slot = 3;
+			L2HeaderSH *header = new L2HeaderSH(partner_id);
+			header->slot_offset = 2;
+			LinkProposal proposal = LinkProposal();
+			proposal.center_frequency = mac->getReservationManager()->getP2PFreqChannels().at(0)->getCenterFrequency();
+			proposal.slot_offset = 10;
+			header->link_requests.push_back(L2HeaderSH::LinkRequest(id, proposal));
+			header->link_requests.push_back(L2HeaderSH::LinkRequest(MacId(44), proposal));
+			link_manager->processBroadcastMessage(partner_id, header);
+			// the third-party request has locked the proposed resources, so ours can't be accepted
+			const auto *table = mac->getReservationManager()->getReservationTable(mac->getReservationManager()->getFreqChannelByCenterFreq(proposal.center_frequency));
+			CPPUNIT_ASSERT_EQUAL(true, table->getReservation(proposal.slot_offset).isLocked());
+			CPPUNIT_ASSERT_EQUAL(true, link_manager->link_replies.empty());
+			CPPUNIT_ASSERT_EQUAL(LinkManager::awaiting_request_generation, mac->getLinkManager(partner_id)->getLinkStatus());
+			delete header;
+		}
+
 		void testRememberAdvertisedSlotOffset() {
 			CPPUNIT_ASSERT_THROW(mac->getNeighborObserver().getNextExpectedBroadcastSlotOffset(partner_id), std::invalid_argument);
 			L2HeaderSH *header = new L2HeaderSH(partner_id);
@@ -384,9 +458,120 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		}		
 
 
+		void testPrecomputeLinkProposals() {
+			// the partner's next broadcast must be known to anticipate the proposals, and come after our own
+			mac->update(1);
+			mac->execute();
+			L2HeaderSH *header = new L2HeaderSH(partner_id);
+			header->slot_offset = link_manager->next_broadcast_slot + 5;
+			link_manager->processBroadcastMessage(partner_id, header);
+			delete header;
+			mac->onSlotEnd();
+			mac->update(1);
+			link_manager->sendLinkRequest(partner_id);
+			uint64_t current_slot = mac->getCurrentSlot();
+			auto it = link_manager->precomputed_link_proposals.find(partner_id);
+			CPPUNIT_ASSERT(it != link_manager->precomputed_link_proposals.end());
+			const auto precomputed = it->second;
+			CPPUNIT_ASSERT_EQUAL(current_slot + link_manager->next_broadcast_slot, precomputed.transmission_slot);
+			CPPUNIT_ASSERT_EQUAL(link_manager->num_proposals_unadvertised_link_requests, precomputed.proposals.size());
+			// not usable before the transmission slot
+			std::vector<LinkProposal> proposals;
+			CPPUNIT_ASSERT_EQUAL(false, link_manager->usePrecomputedLinkProposals(precomputed, (int) (precomputed.min_slot - current_slot), precomputed.period, 1, 1, precomputed.num_proposals, proposals));
+			// changed reservations that don't concern the proposals are revalidated
+			const LinkProposal &proposal = precomputed.proposals.at(0);
+			ReservationTable *table = mac->getReservationManager()->getReservationTable(mac->getReservationManager()->getFreqChannelByCenterFreq(proposal.center_frequency));
+			table->mark(proposal.slot_offset + 1, Reservation(MacId(44), Reservation::BUSY));
+			CPPUNIT_ASSERT(mac->getReservationManager()->getGeneration() != precomputed.generation);
+			// transmit the link request
+			size_t num_slots = 0, max_slots = 100;
+			while (env->phy_layer->outgoing_packets.empty() && num_slots++ < max_slots) {
+				mac->execute();
+				mac->onSlotEnd();
+				if (env->phy_layer->outgoing_packets.empty())
+					mac->update(1);
+			}
+			CPPUNIT_ASSERT_EQUAL(size_t(1), env->phy_layer->outgoing_packets.size());
+			CPPUNIT_ASSERT_EQUAL(precomputed.transmission_slot, mac->getCurrentSlot());
+			// the precomputed proposals have been sent rather than recomputed
+			CPPUNIT_ASSERT_EQUAL(size_t(1), link_manager->num_precomputed_link_proposals_used);
+			const auto *sent_header = (L2HeaderSH*) env->phy_layer->outgoing_packets.at(0)->getHeaders().at(0);
+			CPPUNIT_ASSERT_EQUAL(precomputed.proposals.size(), sent_header->link_requests.size());
+			for (size_t i = 0; i < precomputed.proposals.size(); i++) {
+				const auto &sent_proposal = sent_header->link_requests.at(i).proposed_link;
+				CPPUNIT_ASSERT_EQUAL(precomputed.proposals.at(i).center_frequency, sent_proposal.center_frequency);
+				CPPUNIT_ASSERT_EQUAL(precomputed.proposals.at(i).slot_offset - (int) (precomputed.transmission_slot - precomputed.found_at_slot), sent_proposal.slot_offset);
+			}
+			CPPUNIT_ASSERT(link_manager->precomputed_link_proposals.find(partner_id) == link_manager->precomputed_link_proposals.end());
+		}
+
+		void testStalePrecomputedLinkProposals() {
+			mac->update(1);
+			mac->execute();
+			L2HeaderSH *header = new L2HeaderSH(partner_id);
+			header->slot_offset = link_manager->next_broadcast_slot + 5;
+			link_manager->processBroadcastMessage(partner_id, header);
+			delete header;
+			mac->onSlotEnd();
+			mac->update(1);
+			link_manager->sendLinkRequest(partner_id);
+			const auto precomputed = link_manager->precomputed_link_proposals.at(partner_id);
+			// reservations that concern the proposals make them stale
+			const LinkProposal &proposal = precomputed.proposals.at(0);
+			ReservationTable *table = mac->getReservationManager()->getReservationTable(mac->getReservationManager()->getFreqChannelByCenterFreq(proposal.center_frequency));
+			table->mark(proposal.slot_offset, Reservation(MacId(44), Reservation::BUSY));
+			size_t num_slots = 0, max_slots = 100;
+			while (env->phy_layer->outgoing_packets.empty() && num_slots++ < max_slots) {
+				mac->execute();
+				mac->onSlotEnd();
+				if (env->phy_layer->outgoing_packets.empty())
+					mac->update(1);
+			}
+			CPPUNIT_ASSERT_EQUAL(size_t(1), env->phy_layer->outgoing_packets.size());
+			// so proposals are found at the transmission slot
+			CPPUNIT_ASSERT_EQUAL(size_t(0), link_manager->num_precomputed_link_proposals_used);
+			const auto *sent_header = (L2HeaderSH*) env->phy_layer->outgoing_packets.at(0)->getHeaders().at(0);
+			CPPUNIT_ASSERT_EQUAL(false, sent_header->link_requests.empty());
+			// cancelling a request drops its proposals
+			link_manager->sendLinkRequest(partner_id);
+			CPPUNIT_ASSERT(link_manager->precomputed_link_proposals.find(partner_id) != link_manager->precomputed_link_proposals.end());
+			link_manager->cancelLinkRequest(partner_id);
+			CPPUNIT_ASSERT(link_manager->precomputed_link_proposals.find(partner_id) == link_manager->precomputed_link_proposals.end());
+		}
+
+		void testCancelLinkRequestsAndReplies() {
+			for (int dest : {10, 11, 10, 12})
+				link_manager->link_requests.push_back(MacId(dest), dest);
+			CPPUNIT_ASSERT_EQUAL(size_t(4), link_manager->link_requests.size());
+			// all requests of one destination are cancelled
+			CPPUNIT_ASSERT_EQUAL(size_t(2), link_manager->cancelLinkRequest(MacId(10)));
+			CPPUNIT_ASSERT_EQUAL(size_t(0), link_manager->cancelLinkRequest(MacId(10)));
+			CPPUNIT_ASSERT_EQUAL(size_t(2), link_manager->link_requests.size());
+			CPPUNIT_ASSERT_EQUAL(false, link_manager->link_requests.contains(MacId(10)));
+			// the others keep their order
+			CPPUNIT_ASSERT_EQUAL(MacId(11), link_manager->link_requests.front().first);
+			link_manager->link_requests.pop_front();
+			CPPUNIT_ASSERT_EQUAL(MacId(12), link_manager->link_requests.front().first);
+			CPPUNIT_ASSERT_EQUAL(uint64_t(12), link_manager->link_requests.front().second);
+			CPPUNIT_ASSERT_EQUAL(size_t(1), link_manager->cancelLinkRequest(MacId(12)));
+			CPPUNIT_ASSERT_EQUAL(true, link_manager->link_requests.empty());
+			// same for replies, where copies are independent of the original queue
+			for (int dest : {10, 11})
+				link_manager->link_replies.push_back(MacId(dest), L2HeaderSH::LinkReply(MacId(dest), LinkProposal()));
+			auto copied_replies = link_manager->link_replies;
+			CPPUNIT_ASSERT_EQUAL(size_t(1), link_manager->cancelLinkReply(MacId(10)));
+			CPPUNIT_ASSERT_EQUAL(size_t(1), link_manager->link_replies.size());
+			CPPUNIT_ASSERT_EQUAL(MacId(11), link_manager->link_replies.front().second.dest_id);
+			CPPUNIT_ASSERT_EQUAL(size_t(2), copied_replies.size());
+			CPPUNIT_ASSERT_EQUAL(size_t(1), copied_replies.erase(MacId(11)));
+			CPPUNIT_ASSERT_EQUAL(MacId(10), copied_replies.front().second.dest_id);
+		}
+
 	CPPUNIT_TEST_SUITE(SHLinkManagerTests);
 		CPPUNIT_TEST(testBroadcastSlotSelection);
+		CPPUNIT_TEST(testBroadcastSlotSelectionSamplesCandidates);
 		CPPUNIT_TEST(testScheduleBroadcastSlot);
+		CPPUNIT_TEST(testScheduleBroadcastSlotWithoutConformantForecast);
 		CPPUNIT_TEST(testBroadcast);
 		// CPPUNIT_TEST(testSendLinkRequestOnBC);						
 		CPPUNIT_TEST(testAutoScheduleBroadcastSlotIfTheresNoData);
@@ -396,14 +581,19 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		CPPUNIT_TEST(testSlotAdvertisementWhenAutoAdvertisementIsOnAndTheresMoreData);
 		CPPUNIT_TEST(testMacDelay);		
 		CPPUNIT_TEST(testSHChannelAccessDelay);	
-		CPPUNIT_TEST(testNoCandidateSlotsForParticularValues);			
+		CPPUNIT_TEST(testNoCandidateSlotsForParticularValues);
+		CPPUNIT_TEST(testCandidateSlotTable);			
 		CPPUNIT_TEST(testDutyCycleMacDelay);
 		CPPUNIT_TEST(testMarkAdvertisedBroadcastSlot);
 		CPPUNIT_TEST(testRescheduleBroadcastUponCollision);
+		CPPUNIT_TEST(testOwnLinkRequestRespectsThirdPartyLocks);
 		CPPUNIT_TEST(testRememberAdvertisedSlotOffset);		
 		CPPUNIT_TEST(testForgetAdvertisedSlotOffset);								
 		CPPUNIT_TEST(testAutoStartBroadcasts);
 		CPPUNIT_TEST(testFixedPPPeriod);		
+		CPPUNIT_TEST(testPrecomputeLinkProposals);
+		CPPUNIT_TEST(testStalePrecomputedLinkProposals);
+		CPPUNIT_TEST(testCancelLinkRequestsAndReplies);
 		CPPUNIT_TEST_SUITE_END();
 	};
 
@@ -48,8 +48,45 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			}
 		}		
 
+		void testBurstPatternViews() {
+			int num_forward_bursts = 2, num_reverse_bursts = 1, period = 1, timeout = 3;
+			const auto &pattern = SlotCalculator::getAlternatingBurstPattern(num_forward_bursts, num_reverse_bursts, period, timeout);
+			// the same pattern should be served from the cache
+			CPPUNIT_ASSERT(&pattern == &SlotCalculator::getAlternatingBurstPattern(num_forward_bursts, num_reverse_bursts, period, timeout));
+			CPPUNIT_ASSERT_EQUAL(size_t(num_forward_bursts*timeout), pattern.tx_offsets.size());
+			CPPUNIT_ASSERT_EQUAL(size_t(num_reverse_bursts*timeout), pattern.rx_offsets.size());
+			// views should match the computed slots, also when some lie in the past
+			for (int start_slot_offset : {0, 7, -15, -1000}) {
+				auto tx_rx_slots = SlotCalculator::calculateAlternatingBursts(start_slot_offset, num_forward_bursts, num_reverse_bursts, period, timeout);
+				auto views = SlotCalculator::viewAlternatingBursts(start_slot_offset, num_forward_bursts, num_reverse_bursts, period, timeout);
+				CPPUNIT_ASSERT_EQUAL(tx_rx_slots.first.size(), views.first.size());
+				CPPUNIT_ASSERT_EQUAL(tx_rx_slots.second.size(), views.second.size());
+				for (size_t i = 0; i < views.first.size(); i++)
+					CPPUNIT_ASSERT_EQUAL(tx_rx_slots.first.at(i), views.first.at(i));
+				for (size_t i = 0; i < views.second.size(); i++)
+					CPPUNIT_ASSERT_EQUAL(tx_rx_slots.second.at(i), views.second.at(i));
+			}
+			// start 7, increment 10: TX at 7, 17, 37, 47, 67, 77 and RX at 27, 57, 87
+			auto views = SlotCalculator::viewAlternatingBursts(7, num_forward_bursts, num_reverse_bursts, period, timeout);
+			CPPUNIT_ASSERT_EQUAL(17, views.first.at(1));
+			CPPUNIT_ASSERT_EQUAL(87, views.second.at(2));
+			CPPUNIT_ASSERT_THROW(views.second.at(3), std::out_of_range);
+			// with a start 15 slots in the past, only the bursts from slot 2 on remain
+			views = SlotCalculator::viewAlternatingBursts(-15, num_forward_bursts, num_reverse_bursts, period, timeout);
+			CPPUNIT_ASSERT_EQUAL(size_t(4), views.first.size());
+			CPPUNIT_ASSERT_EQUAL(15, views.first.at(0));
+			CPPUNIT_ASSERT_EQUAL(5, views.second.at(0));
+		}
+
+		void testBurstIncrements() {
+			for (int period = 0; period < SlotCalculator::NUM_TABULATED_PERIODS + 2; period++)
+				CPPUNIT_ASSERT_EQUAL((int) (5*std::pow(2, period)), SlotCalculator::getBurstIncrement(period));
+		}
+
 	CPPUNIT_TEST_SUITE(SlotCalculatorTests);
 		CPPUNIT_TEST(testAlternatingBursts);			
+		CPPUNIT_TEST(testBurstPatternViews);
+		CPPUNIT_TEST(testBurstIncrements);
 	CPPUNIT_TEST_SUITE_END();
 	};
 
@@ -0,0 +1,81 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <thread>
+#include "../SlotProfiler.hpp"
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+	class SlotProfilerTests : public CppUnit::TestFixture {
+	private:
+		SlotProfiler *profiler;
+
+	public:
+		void setUp() override {
+			profiler = new SlotProfiler();
+		}
+
+		void tearDown() override {
+			delete profiler;
+		}
+
+		void testRecord() {
+			CPPUNIT_ASSERT_EQUAL(uint64_t(0), profiler->getCount(SlotProfiler::mac_update));
+			CPPUNIT_ASSERT_EQUAL(uint64_t(0), profiler->getHistogram(SlotProfiler::mac_update).getNumSamples());
+			profiler->record(SlotProfiler::mac_update, 100);
+			profiler->record(SlotProfiler::mac_update, 300);
+			profiler->record(SlotProfiler::mac_execute, 50);
+			CPPUNIT_ASSERT_EQUAL(uint64_t(2), profiler->getCount(SlotProfiler::mac_update));
+			CPPUNIT_ASSERT_EQUAL(uint64_t(400), profiler->getTotal(SlotProfiler::mac_update));
+			CPPUNIT_ASSERT_EQUAL(uint64_t(300), profiler->getMax(SlotProfiler::mac_update));
+			CPPUNIT_ASSERT_EQUAL(uint64_t(2), profiler->getHistogram(SlotProfiler::mac_update).getNumSamples());
+			CPPUNIT_ASSERT_EQUAL(uint64_t(1), profiler->getCount(SlotProfiler::mac_execute));
+			CPPUNIT_ASSERT_EQUAL(uint64_t(0), profiler->getCount(SlotProfiler::mac_on_slot_end));
+			profiler->reset();
+			CPPUNIT_ASSERT_EQUAL(uint64_t(0), profiler->getCount(SlotProfiler::mac_update));
+			CPPUNIT_ASSERT_THROW(profiler->record(SlotProfiler::num_phases, 1), std::invalid_argument);
+		}
+
+		void testScopedTimer() {
+			{
+				ScopedPhaseTimer timer(profiler, SlotProfiler::reservation_table_update);
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			CPPUNIT_ASSERT_EQUAL(uint64_t(1), profiler->getCount(SlotProfiler::reservation_table_update));
+			CPPUNIT_ASSERT_GREATEREQUAL(uint64_t(1000000), profiler->getTotal(SlotProfiler::reservation_table_update));
+			// a timer without profiler does nothing
+			{
+				ScopedPhaseTimer timer(nullptr, SlotProfiler::reservation_table_update);
+			}
+			CPPUNIT_ASSERT_EQUAL(uint64_t(1), profiler->getCount(SlotProfiler::reservation_table_update));
+		}
+
+		void testPhaseNames() {
+			for (int phase = 0; phase < SlotProfiler::num_phases; phase++)
+				CPPUNIT_ASSERT(!SlotProfiler::getPhaseName((SlotProfiler::Phase) phase).empty());
+			CPPUNIT_ASSERT_EQUAL(std::string("mac_update"), SlotProfiler::getPhaseName(SlotProfiler::mac_update));
+		}
+
+	CPPUNIT_TEST_SUITE(SlotProfilerTests);
+		CPPUNIT_TEST(testRecord);
+		CPPUNIT_TEST(testScopedTimer);
+		CPPUNIT_TEST(testPhaseNames);
+	CPPUNIT_TEST_SUITE_END();
+	};
+
+}
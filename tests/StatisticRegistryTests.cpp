@@ -0,0 +1,90 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "../StatisticRegistry.hpp"
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+	class StatisticRegistryTests : public CppUnit::TestFixture {
+	private:
+		StatisticRegistry *registry;
+		TrackedStatistic *stat1, *stat2, *stat3;
+
+	public:
+		void setUp() override {
+			registry = new StatisticRegistry();
+			stat1 = new TrackedStatistic("statistic_registry_test_1", nullptr);
+			stat2 = new TrackedStatistic("statistic_registry_test_2", nullptr);
+			stat3 = new TrackedStatistic("statistic_registry_test_3", nullptr);
+			registry->add(stat1);
+			registry->add(stat2);
+			registry->add(stat3);
+		}
+
+		void tearDown() override {
+			delete registry;
+			delete stat1;
+			delete stat2;
+			delete stat3;
+		}
+
+		void testOnlyChangedStatisticsAreEmitted() {
+			CPPUNIT_ASSERT_EQUAL(size_t(3), registry->size());
+			CPPUNIT_ASSERT_EQUAL(size_t(0), registry->getNumDirty());
+			CPPUNIT_ASSERT_EQUAL(size_t(0), registry->update(1));
+			stat1->increment();
+			stat1->increment();
+			stat3->capture(42.0);
+			CPPUNIT_ASSERT_EQUAL(size_t(2), registry->getNumDirty());
+			CPPUNIT_ASSERT_EQUAL(size_t(2), registry->update(1));
+			CPPUNIT_ASSERT_EQUAL(size_t(0), registry->getNumDirty());
+			CPPUNIT_ASSERT_EQUAL(2.0, stat1->get());
+			CPPUNIT_ASSERT_EQUAL(42.0, stat3->get());
+		}
+
+		void testEmissionInterval() {
+			CPPUNIT_ASSERT_THROW(registry->setEmissionInterval(0), std::invalid_argument);
+			registry->setEmissionInterval(5);
+			stat2->increment();
+			for (size_t t = 0; t < 4; t++)
+				CPPUNIT_ASSERT_EQUAL(size_t(0), registry->update(1));
+			CPPUNIT_ASSERT_EQUAL(size_t(1), registry->getNumDirty());
+			CPPUNIT_ASSERT_EQUAL(size_t(1), registry->update(1));
+			// several slots at once
+			stat2->increment();
+			CPPUNIT_ASSERT_EQUAL(size_t(1), registry->update(5));
+			// flushing emits immediately
+			stat1->increment();
+			CPPUNIT_ASSERT_EQUAL(size_t(1), registry->flush());
+		}
+
+		void testAddTwice() {
+			CPPUNIT_ASSERT_THROW(registry->add(stat1), std::invalid_argument);
+			StatisticRegistry other_registry = StatisticRegistry();
+			CPPUNIT_ASSERT_THROW(other_registry.add(stat2), std::invalid_argument);
+			CPPUNIT_ASSERT_EQUAL(size_t(3), registry->size());
+		}
+
+	CPPUNIT_TEST_SUITE(StatisticRegistryTests);
+		CPPUNIT_TEST(testOnlyChangedStatisticsAreEmitted);
+		CPPUNIT_TEST(testEmissionInterval);
+		CPPUNIT_TEST(testAddTwice);
+	CPPUNIT_TEST_SUITE_END();
+	};
+
+}
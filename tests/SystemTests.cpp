@@ -329,6 +329,63 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			for (auto d : duty_cycle_contrib)
 				used_budget += d;
 			CPPUNIT_ASSERT_GREATER(0.0, used_budget);
+			// the running aggregate should agree
+			const PPDutyCycleBudget &aggregate = mac_layer_me->getPPDutyCycleBudget();
+			CPPUNIT_ASSERT_EQUAL(true, aggregate.contains(partner_id));
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(used_budget, aggregate.getTotal(), 1e-9);
+			CPPUNIT_ASSERT_EQUAL(pp_me->getRemainingTimeout(), aggregate.getTimeouts().begin()->first);
+			// and the link should leave it once it is cancelled
+			pp_me->cancelLink();
+			CPPUNIT_ASSERT_EQUAL(size_t(0), aggregate.size());
+			CPPUNIT_ASSERT_EQUAL(0.0, aggregate.getTotal());
+		}
+
+		void testPPDutyCycleBudget() {
+			PPDutyCycleBudget budget;
+			budget.set(MacId(3), 0.02, 10);
+			budget.set(MacId(1), 0.025, 5);
+			budget.set(MacId(2), 0.0125, 5);
+			CPPUNIT_ASSERT_EQUAL(size_t(3), budget.size());
+			CPPUNIT_ASSERT_EQUAL(0.0575, budget.getTotal());
+			// ascending timeouts, ties broken by ID
+			auto it = budget.getTimeouts().begin();
+			CPPUNIT_ASSERT(MacId(1) == (it++)->second);
+			CPPUNIT_ASSERT(MacId(2) == (it++)->second);
+			CPPUNIT_ASSERT(MacId(3) == (it++)->second);
+			// updates replace previous contributions
+			budget.set(MacId(3), 0.01, 1);
+			CPPUNIT_ASSERT_EQUAL(0.0475, budget.getTotal());
+			CPPUNIT_ASSERT(MacId(3) == budget.getTimeouts().begin()->second);
+			budget.remove(MacId(1));
+			budget.remove(MacId(42));
+			CPPUNIT_ASSERT_EQUAL(size_t(2), budget.size());
+			CPPUNIT_ASSERT_EQUAL(0.0225, budget.getTotal());
+			// the vectors are ordered by ID
+			auto vectors = budget.toVectors();
+			CPPUNIT_ASSERT_EQUAL(0.0125, vectors.first.at(0));
+			CPPUNIT_ASSERT_EQUAL(1, vectors.second.at(1));
+		}
+
+		void testDutyCycleForecast() {
+			// at most 10 transmissions within 100 slots
+			DutyCycle duty_cycle = DutyCycle(100, 0.1, 4);
+			CPPUNIT_ASSERT_EQUAL(10u, duty_cycle.getMaxNumTransmissionsPerPeriod());
+			ReservationTable tx_table = ReservationTable(512);
+			CPPUNIT_ASSERT_EQUAL(0u, duty_cycle.getMaxScheduledTransmissions(&tx_table, 0, 300));
+			for (int t = 50; t < 59; t++)
+				tx_table.mark(t, Reservation(partner_id, Reservation::TX));
+			CPPUNIT_ASSERT_EQUAL(9u, duty_cycle.getMaxScheduledTransmissions(&tx_table, 0, 300));
+			CPPUNIT_ASSERT_EQUAL(0u, duty_cycle.getMaxScheduledTransmissions(&tx_table, 59, 300));
+			// one more fits, two don't
+			CPPUNIT_ASSERT_EQUAL(true, duty_cycle.isForecastConformant(&tx_table, {100}));
+			CPPUNIT_ASSERT_EQUAL(false, duty_cycle.isForecastConformant(&tx_table, {100, 140}));
+			// unless the second is outside every window of the scheduled ones
+			CPPUNIT_ASSERT_EQUAL(true, duty_cycle.isForecastConformant(&tx_table, {100, 158}));
+			tx_table.mark(59, Reservation(partner_id, Reservation::TX));
+			// now the next transmission has to wait until the window starting at t=50 has passed
+			CPPUNIT_ASSERT_EQUAL(false, duty_cycle.isForecastConformant(&tx_table, {100}));
+			CPPUNIT_ASSERT_EQUAL(150, duty_cycle.getEarliestConformantOffset(&tx_table, 1));
+			CPPUNIT_ASSERT_EQUAL(200, duty_cycle.getEarliestConformantOffset(&tx_table, 200));
 		}
 
 		void testDutyCyclePeriodicityPP() {			
@@ -646,6 +703,87 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			CPPUNIT_ASSERT_EQUAL(mac_layer_me->getNeighborObserver().avg_last_seen.at(partner_id).get(), mac_layer_me->getNeighborObserver().getAvgBeaconDelay());
 		}
 
+		void testAvgBeaconDelayAggregate() {
+			NeighborObserver observer = NeighborObserver(1000);
+			MacId id1 = MacId(1), id2 = MacId(2);
+			observer.reportActivity(id1);
+			observer.reportActivity(id2);
+			// no averages yet
+			CPPUNIT_ASSERT_EQUAL(size_t(0), observer.num_positive_avg_last_seen);
+			for (size_t t = 0; t < 10; t++)
+				observer.onSlotEnd();
+			observer.reportActivity(id1);
+			CPPUNIT_ASSERT_EQUAL(10.0, observer.getAvgBeaconDelay());
+			for (size_t t = 0; t < 20; t++)
+				observer.onSlotEnd();
+			observer.reportActivity(id1);
+			observer.reportActivity(id2);
+			// id1 averages (10+20)/2, id2 has seen a single gap of 30 slots
+			CPPUNIT_ASSERT_EQUAL(size_t(2), observer.num_positive_avg_last_seen);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL((15.0 + 30.0) / 2.0, observer.getAvgBeaconDelay(), 1e-9);
+		}
+
+		void testAdvertisedLinkProposalStore() {
+			NeighborObserver observer = NeighborObserver(1000);
+			MacId id = MacId(1);
+			unsigned long current_slot = 100;
+			CPPUNIT_ASSERT(observer.getAdvertisedLinkProposals(id, current_slot).empty());
+			// save more proposals than are kept
+			size_t num_proposals = NeighborObserver::MAX_NUM_ADVERTISED_LINK_PROPOSALS + 2;
+			for (size_t i = 0; i < num_proposals; i++) {
+				LinkProposal proposal;
+				proposal.slot_offset = i + 1;
+				observer.addAdvertisedLinkProposal(id, current_slot, proposal);
+			}
+			const auto &proposals = observer.getAdvertisedLinkProposals(id, current_slot);
+			CPPUNIT_ASSERT_EQUAL(NeighborObserver::MAX_NUM_ADVERTISED_LINK_PROPOSALS, proposals.size());
+			// the oldest ones should've been dropped
+			CPPUNIT_ASSERT_EQUAL(3, proposals.at(0).slot_offset);
+			// offsets should be normalized to the current slot and started proposals removed
+			current_slot += 5;
+			const auto &remaining_proposals = observer.getAdvertisedLinkProposals(id, current_slot);
+			CPPUNIT_ASSERT_EQUAL(num_proposals - 5, remaining_proposals.size());
+			CPPUNIT_ASSERT_EQUAL(1, remaining_proposals.at(0).slot_offset);
+			CPPUNIT_ASSERT_EQUAL((int) num_proposals - 5, remaining_proposals.at(remaining_proposals.size() - 1).slot_offset);
+			// once all have expired, the neighbor is forgotten
+			current_slot += num_proposals;
+			CPPUNIT_ASSERT(observer.getAdvertisedLinkProposals(id, current_slot).empty());
+			CPPUNIT_ASSERT_EQUAL(size_t(0), observer.advertised_link_proposals.size());
+		}
+
+		void testNeighborObserverExpiry() {
+			// more slots until expiry than the timing wheel has buckets, s.t. neighbors have to be revisited on each turn of the wheel
+			unsigned int max_last_seen = NeighborObserver::MAX_NUM_EXPIRY_BUCKETS + 10;
+			NeighborObserver observer = NeighborObserver(max_last_seen);
+			MacId id1 = MacId(1), id2 = MacId(2);
+			observer.reportActivity(id1);
+			observer.reportActivity(id2);
+			observer.reportBroadcastSlotAdvertisement(id2, 100);
+			// a neighbor that never becomes active
+			MacId id3 = MacId(3);
+			observer.reportBroadcastSlotAdvertisement(id3, 10);
+			CPPUNIT_ASSERT_EQUAL(size_t(2), observer.getNumActiveNeighbors());
+			for (unsigned int t = 0; t < max_last_seen / 2; t++)
+				observer.onSlotEnd();
+			// seeing id2 again should postpone its expiry
+			observer.reportActivity(id2);
+			for (unsigned int t = max_last_seen / 2; t < max_last_seen - 1; t++)
+				observer.onSlotEnd();
+			CPPUNIT_ASSERT_EQUAL(size_t(2), observer.getNumActiveNeighbors());
+			observer.onSlotEnd();
+			CPPUNIT_ASSERT_EQUAL(size_t(1), observer.getNumActiveNeighbors());
+			CPPUNIT_ASSERT_EQUAL(id2, observer.getActiveNeighbors().at(0));
+			// its advertised broadcast slot lies in the past
+			CPPUNIT_ASSERT_THROW(observer.getNextExpectedBroadcastSlotOffset(id2), std::invalid_argument);
+			// advertisements that have passed are erased, also those of inactive neighbors
+			CPPUNIT_ASSERT_THROW(observer.getNextExpectedBroadcastSlotOffset(id3), std::invalid_argument);
+			CPPUNIT_ASSERT_EQUAL(size_t(0), observer.advertised_broadcast_slots.size());
+			CPPUNIT_ASSERT_EQUAL(size_t(0), observer.advertised_broadcast_slots_by_slot.size());
+			for (unsigned int t = 0; t < max_last_seen / 2; t++)
+				observer.onSlotEnd();
+			CPPUNIT_ASSERT_EQUAL(size_t(0), observer.getNumActiveNeighbors());
+		}
+
 		void testDontReportMissingSHPacketToArq() {
 			size_t num_slots = 0, max_slots = 250;
 			// wait until "I" have noticed "you"
@@ -732,6 +870,8 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		CPPUNIT_TEST(testMACDelays);								
 		CPPUNIT_TEST(testMissedLastLinkEstablishmentOpportunity);										
 		CPPUNIT_TEST(testDutyCycleContributions);
+		CPPUNIT_TEST(testPPDutyCycleBudget);
+		CPPUNIT_TEST(testDutyCycleForecast);
 		CPPUNIT_TEST(testDutyCyclePeriodicityPP);
 		CPPUNIT_TEST(testDutyCyclePeriodicityPPOnlyOneLinkNeeded);	
 		CPPUNIT_TEST(testDutyCycleSHBudgetOnlyOneLinkNeeded);		
@@ -750,6 +890,9 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 		CPPUNIT_TEST(testDutyCycleGetSHOffsetFourPPLinks);	
 		CPPUNIT_TEST(testDutyCycleGetSHOffsetFourPPLinksFromCrash);	
 		CPPUNIT_TEST(testMeasureTimeInbetweenBeaconReceptions);			
+		CPPUNIT_TEST(testAvgBeaconDelayAggregate);
+		CPPUNIT_TEST(testAdvertisedLinkProposalStore);
+		CPPUNIT_TEST(testNeighborObserverExpiry);
 		CPPUNIT_TEST(testDontReportMissingSHPacketToArq);
 		CPPUNIT_TEST(testDontReportMissingPPPacketOnSHToArq);
 	CPPUNIT_TEST_SUITE_END();
@@ -78,6 +78,31 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			CPPUNIT_ASSERT_EQUAL(link.num_slots_until_expected_link_reply, second_ref.num_slots_until_expected_link_reply);
 		}
 
+		/** Both orderings of the link partners should yield the same link. */
+		void testGetThirdPartyLinkIsOrderInsensitive() {
+			auto &link = mac->getThirdPartyLink(id_initiator, id_recipient);
+			auto &reversed_link = mac->getThirdPartyLink(id_recipient, id_initiator);
+			CPPUNIT_ASSERT(&link == &reversed_link);
+			CPPUNIT_ASSERT_EQUAL(size_t(1), mac->getNumThirdPartyLinks());
+			// the first ordering determines the link's initiator and recipient
+			CPPUNIT_ASSERT_EQUAL(id_initiator, reversed_link.getIdLinkInitiator());
+			CPPUNIT_ASSERT_EQUAL(id_recipient, reversed_link.getIdLinkRecipient());
+			// references remain valid as more links are added
+			for (int i = 0; i < 100; i++)
+				mac->getThirdPartyLink(MacId(1000 + i), MacId(2000 + i));
+			CPPUNIT_ASSERT_EQUAL(size_t(101), mac->getNumThirdPartyLinks());
+			CPPUNIT_ASSERT(&link == &mac->getThirdPartyLink(id_recipient, id_initiator));
+			CPPUNIT_ASSERT_EQUAL(id_initiator, link.getIdLinkInitiator());
+			// links are iterated sorted by (lower ID, higher ID), regardless of the initiator
+			auto &reversed_ids_link = mac->getThirdPartyLink(MacId(7), MacId(5));
+			CPPUNIT_ASSERT(&reversed_ids_link == &mac->third_party_links.begin()->second);
+			uint64_t last_key = 0;
+			for (const auto &item : mac->third_party_links) {
+				CPPUNIT_ASSERT(item.first >= last_key);
+				last_key = item.first;
+			}
+		}
+
 		/** A link request should lock all links that are proposed. */
 		void testLinkRequestLocks() {
 			// wait until advertisement has been received
@@ -1162,8 +1187,54 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			CPPUNIT_ASSERT_GREATER(size_t(0), mac->getThirdPartyLink(id_initiator_2, id_recipient_2).scheduled_resources.size());			
 		}
 
+		void testIdleLinkIsRemoved() {
+			mac->setThirdPartyLinkIdleTimeout(10);
+			mac->getThirdPartyLink(id_initiator, id_recipient);
+			CPPUNIT_ASSERT_EQUAL(size_t(1), mac->getNumThirdPartyLinks());
+			for (size_t t = 0; t < 9; t++) {
+				mac->update(1);
+				mac->execute();
+				mac->onSlotEnd();
+			}
+			CPPUNIT_ASSERT_EQUAL(size_t(1), mac->getNumThirdPartyLinks());
+			mac->update(1);
+			mac->execute();
+			mac->onSlotEnd();
+			CPPUNIT_ASSERT_EQUAL(size_t(0), mac->getNumThirdPartyLinks());
+		}
+
+		void testResourceIndex() {
+			mac_initiator->notifyOutgoing(1, id_recipient);
+			size_t num_slots = 0, max_slots = 500;
+			auto &third_party_link = mac->getThirdPartyLink(id_initiator, id_recipient);
+			CPPUNIT_ASSERT(mac->third_party_link_resource_index.empty());
+			while (third_party_link.status != ThirdPartyLink::Status::received_request_awaiting_reply && num_slots++ < max_slots) {
+				mac_initiator->update(1);
+				mac_recipient->update(1);
+				mac->update(1);
+				mac_initiator->execute();
+				mac_recipient->execute();
+				mac->execute();
+				mac_initiator->onSlotEnd();
+				mac_recipient->onSlotEnd();
+				mac->onSlotEnd();
+			}
+			CPPUNIT_ASSERT_LESS(max_slots, num_slots);
+			// all proposed resources are indexed, which includes the locked ones
+			CPPUNIT_ASSERT_GREATEREQUAL(third_party_link.locked_resources_for_initiator.size() + third_party_link.locked_resources_for_recipient.size(), mac->third_party_link_resource_index.size());
+			for (const auto &pair : mac->third_party_link_resource_index) {
+				CPPUNIT_ASSERT_EQUAL(size_t(1), pair.second.size());
+				CPPUNIT_ASSERT(*pair.second.begin() == &third_party_link);
+			}
+			size_t num_locks = third_party_link.locked_resources_for_initiator.size() + third_party_link.locked_resources_for_recipient.size();
+			third_party_link.reset();
+			CPPUNIT_ASSERT(mac->third_party_link_resource_index.empty());
+			CPPUNIT_ASSERT_EQUAL(num_locks, third_party_link.getFreedResources().size());
+		}
+
 		CPPUNIT_TEST_SUITE(ThirdPartyLinkTests);		
-			CPPUNIT_TEST(testGetThirdPartyLink);			
+			CPPUNIT_TEST(testGetThirdPartyLink);
+			CPPUNIT_TEST(testGetThirdPartyLinkIsOrderInsensitive);			
 			CPPUNIT_TEST(testLinkRequestLocks);
 			CPPUNIT_TEST(testMissingReplyUnlocks);
 			CPPUNIT_TEST(testExpectedReply);			
@@ -1183,7 +1254,9 @@ namespace TUHH_INTAIRNET_MCSOTDMA {
 			CPPUNIT_TEST(testRequestAndReplySaveLinkInfo);
 			CPPUNIT_TEST(testReplySchedulesBursts);
 			CPPUNIT_TEST(testAnotherLinkResetLocksFutureResources);
-			CPPUNIT_TEST(testAnotherLinkResetSchedulesFutureResources);			
+			CPPUNIT_TEST(testAnotherLinkResetSchedulesFutureResources);
+			CPPUNIT_TEST(testIdleLinkIsRemoved);
+			CPPUNIT_TEST(testResourceIndex);
 		CPPUNIT_TEST_SUITE_END();
 	};
 
@@ -0,0 +1,105 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <sstream>
+#include "../TraceEventWriter.hpp"
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+	class TraceEventWriterTests : public CppUnit::TestFixture {
+	private:
+		TraceEventWriter *writer;
+
+	public:
+		void setUp() override {
+			writer = new TraceEventWriter(42, 5);
+		}
+
+		void tearDown() override {
+			delete writer;
+		}
+
+		void testEvents() {
+			{
+				ScopedTraceEvent event(writer, "onSlotEnd", 10);
+				writer->instant("PPLinkManager::establishLink", 10, 42, 43);
+			}
+			CPPUNIT_ASSERT_EQUAL(size_t(3), writer->getNumEvents());
+			CPPUNIT_ASSERT_EQUAL('B', writer->events.at(0).phase);
+			CPPUNIT_ASSERT_EQUAL('i', writer->events.at(1).phase);
+			CPPUNIT_ASSERT_EQUAL('E', writer->events.at(2).phase);
+			CPPUNIT_ASSERT(writer->events.at(0).timestamp_us <= writer->events.at(2).timestamp_us);
+			// no writer, no events
+			{
+				ScopedTraceEvent event(nullptr, "onSlotEnd", 11);
+			}
+			CPPUNIT_ASSERT_EQUAL(size_t(3), writer->getNumEvents());
+		}
+
+		void testDropWhenFull() {
+			for (int i = 0; i < 7; i++)
+				writer->instant("ThirdPartyLink::reset", i, 1, 2);
+			CPPUNIT_ASSERT_EQUAL(size_t(5), writer->getNumEvents());
+			CPPUNIT_ASSERT_EQUAL(size_t(2), writer->getNumDroppedEvents());
+		}
+
+		void testTerminateOpenSpans() {
+			writer->instant("ThirdPartyLink::reset", 1, 1, 2);
+			{
+				ScopedTraceEvent event(writer, "onSlotEnd", 1);
+				{
+					ScopedTraceEvent nested_event(writer, "processOutgoingNotifications", 1);
+					// the remaining capacity is reserved for both end events
+					writer->instant("PPLinkManager::acceptLink", 1, 42, 43);
+				}
+				// so is the remaining one for the outer end event
+				{
+					ScopedTraceEvent nested_event(writer, "processOutgoingNotifications", 1);
+				}
+			}
+			CPPUNIT_ASSERT_EQUAL(size_t(5), writer->getNumEvents());
+			CPPUNIT_ASSERT_EQUAL(size_t(3), writer->getNumDroppedEvents());
+			std::string phases;
+			for (const auto &event : writer->events)
+				phases += event.phase;
+			CPPUNIT_ASSERT_EQUAL(std::string("iBBEE"), phases);
+		}
+
+		void testJson() {
+			writer->begin("update", 1);
+			writer->end("update", 1);
+			writer->instant("PPLinkManager::acceptLink", 1, 42, 43);
+			std::stringstream ss;
+			writer->write(ss);
+			const std::string json = ss.str();
+			CPPUNIT_ASSERT(json.find("{\"traceEvents\":[") == 0);
+			CPPUNIT_ASSERT(json.find("\"name\":\"update\",\"ph\":\"B\"") != std::string::npos);
+			CPPUNIT_ASSERT(json.find("\"name\":\"update\",\"ph\":\"E\"") != std::string::npos);
+			CPPUNIT_ASSERT(json.find("\"pid\":42") != std::string::npos);
+			CPPUNIT_ASSERT(json.find("\"args\":{\"slot\":1,\"id1\":42,\"id2\":43}") != std::string::npos);
+		}
+
+	CPPUNIT_TEST_SUITE(TraceEventWriterTests);
+		CPPUNIT_TEST(testEvents);
+		CPPUNIT_TEST(testDropWhenFull);
+		CPPUNIT_TEST(testTerminateOpenSpans);
+		CPPUNIT_TEST(testJson);
+	CPPUNIT_TEST_SUITE_END();
+	};
+
+}
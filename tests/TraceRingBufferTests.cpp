@@ -0,0 +1,79 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <sstream>
+#include "../TraceRingBuffer.hpp"
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+	class TraceRingBufferTests : public CppUnit::TestFixture {
+	private:
+		TraceRingBuffer *trace;
+
+	public:
+		void setUp() override {
+			trace = new TraceRingBuffer(4);
+		}
+
+		void tearDown() override {
+			delete trace;
+		}
+
+		void testDisabledByDefault() {
+			CPPUNIT_ASSERT_EQUAL(false, trace->isEnabled());
+			trace->record(TraceRingBuffer::packet_received, 1, 2, 3, 4);
+			CPPUNIT_ASSERT_EQUAL(size_t(0), trace->size());
+			CPPUNIT_ASSERT(trace->records.empty());
+			trace->setEnabled(true);
+			trace->record(TraceRingBuffer::packet_received, 1, 2, 3, 4);
+			CPPUNIT_ASSERT_EQUAL(size_t(1), trace->size());
+			trace->setEnabled(false);
+			trace->record(TraceRingBuffer::packet_received, 2, 2, 3, 4);
+			CPPUNIT_ASSERT_EQUAL(size_t(1), trace->size());
+		}
+
+		void testOverwriteOldest() {
+			trace->setEnabled(true);
+			for (uint64_t t = 0; t < 6; t++)
+				trace->record(TraceRingBuffer::pp_link_expired, t, 42);
+			CPPUNIT_ASSERT_EQUAL(size_t(4), trace->size());
+			CPPUNIT_ASSERT_EQUAL(uint64_t(6), trace->getNumRecorded());
+			for (size_t i = 0; i < trace->size(); i++)
+				CPPUNIT_ASSERT_EQUAL(uint64_t(i + 2), trace->at(i).slot);
+			CPPUNIT_ASSERT_THROW(trace->at(4), std::out_of_range);
+			trace->clear();
+			CPPUNIT_ASSERT_EQUAL(size_t(0), trace->size());
+		}
+
+		void testDump() {
+			trace->setEnabled(true);
+			trace->record(TraceRingBuffer::broadcast_slot_selected, 7, 3, 10);
+			trace->record(TraceRingBuffer::packet_collision, 8, 965, 2);
+			std::stringstream ss;
+			trace->dump(ss);
+			CPPUNIT_ASSERT_EQUAL(std::string("t=7 broadcast_slot_selected 3 10 0\nt=8 packet_collision 965 2 0\n"), ss.str());
+		}
+
+	CPPUNIT_TEST_SUITE(TraceRingBufferTests);
+		CPPUNIT_TEST(testDisabledByDefault);
+		CPPUNIT_TEST(testOverwriteOldest);
+		CPPUNIT_TEST(testDump);
+	CPPUNIT_TEST_SUITE_END();
+	};
+
+}
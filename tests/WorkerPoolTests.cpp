@@ -0,0 +1,89 @@
+// The L-Band Digital Aeronautical Communications System (LDACS) Multi Channel Self-Organized TDMA (TDMA) Library provides an implementation of Multi Channel Self-Organized TDMA (MCSOTDMA) for the LDACS Air-Air Medium Access Control simulator.
+// Copyright (C) 2023  Sebastian Lindner, Konrad Fuger, Musab Ahmed Eltayeb Ahmed, Andreas Timm-Giel, Institute of Communication Networks, Hamburg University of Technology, Hamburg, Germany
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <atomic>
+#include "../WorkerPool.hpp"
+
+namespace TUHH_INTAIRNET_MCSOTDMA {
+	class WorkerPoolTests : public CppUnit::TestFixture {
+	private:
+		WorkerPool *pool;
+		unsigned int num_threads = 3;
+
+	public:
+		void setUp() override {
+			pool = new WorkerPool(num_threads);
+		}
+
+		void tearDown() override {
+			delete pool;
+		}
+
+		void testRun() {
+			CPPUNIT_ASSERT_EQUAL(num_threads, pool->getNumThreads());
+			// several batches in a row, each task writing its own result
+			for (size_t num_tasks : {0, 1, 2, 17, 100}) {
+				std::vector<size_t> results(num_tasks, 0);
+				pool->run(num_tasks, [&results](size_t i) {results.at(i) = i*i;});
+				for (size_t i = 0; i < num_tasks; i++)
+					CPPUNIT_ASSERT_EQUAL(i*i, results.at(i));
+			}
+			std::atomic<size_t> num_calls(0);
+			pool->run(50, [&num_calls](size_t i) {num_calls++;});
+			CPPUNIT_ASSERT_EQUAL(size_t(50), num_calls.load());
+		}
+
+		void testRunWithoutThreads() {
+			WorkerPool sequential_pool(0);
+			std::vector<size_t> results(10, 0);
+			sequential_pool.run(results.size(), [&results](size_t i) {results.at(i) = i + 1;});
+			for (size_t i = 0; i < results.size(); i++)
+				CPPUNIT_ASSERT_EQUAL(i + 1, results.at(i));
+		}
+
+		void testExceptions() {
+			std::atomic<size_t> num_calls(0);
+			bool exception_thrown = false;
+			try {
+				pool->run(20, [&num_calls](size_t i) {
+					num_calls++;
+					if (i == 7 || i == 12)
+						throw std::runtime_error(std::to_string(i));
+				});
+			} catch (const std::runtime_error &e) {
+				exception_thrown = true;
+				// the smallest index's exception is rethrown
+				CPPUNIT_ASSERT_EQUAL(std::string("7"), std::string(e.what()));
+			}
+			CPPUNIT_ASSERT_EQUAL(true, exception_thrown);
+			// all other tasks still ran
+			CPPUNIT_ASSERT_EQUAL(size_t(20), num_calls.load());
+			// and the pool is usable afterwards
+			std::vector<size_t> results(5, 0);
+			pool->run(results.size(), [&results](size_t i) {results.at(i) = 1;});
+			for (size_t result : results)
+				CPPUNIT_ASSERT_EQUAL(size_t(1), result);
+		}
+
+	CPPUNIT_TEST_SUITE(WorkerPoolTests);
+			CPPUNIT_TEST(testRun);
+			CPPUNIT_TEST(testRunWithoutThreads);
+			CPPUNIT_TEST(testExceptions);
+		CPPUNIT_TEST_SUITE_END();
+	};
+}
@@ -31,6 +31,12 @@
 #include "ThirdPartyLinkTests.cpp"
 #include "LinkProposalFinderTests.cpp"
 #include "SlotCalculatorTests.cpp"
+#include "StatisticRegistryTests.cpp"
+#include "LatencyHistogramTests.cpp"
+#include "SlotProfilerTests.cpp"
+#include "TraceEventWriterTests.cpp"
+#include "TraceRingBufferTests.cpp"
+#include "WorkerPoolTests.cpp"
 
 int main() {	
 	CppUnit::TextUi::TestRunner runner;
@@ -49,6 +55,12 @@ int main() {
 	runner.addTest(ThirdPartyLinkTests::suite());
 	runner.addTest(LinkProposalFinderTests::suite());	
 	runner.addTest(SlotCalculatorTests::suite());	
+	runner.addTest(StatisticRegistryTests::suite());
+	runner.addTest(LatencyHistogramTests::suite());
+	runner.addTest(SlotProfilerTests::suite());
+	runner.addTest(TraceEventWriterTests::suite());
+	runner.addTest(TraceRingBufferTests::suite());
+	runner.addTest(WorkerPoolTests::suite());
 
 	runner.run();
 	return runner.result().wasSuccessful() ? 0 : 1;